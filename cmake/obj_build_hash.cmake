@@ -0,0 +1,31 @@
+# Writes the source revision into a header, run on every build (not just at
+# configure time) so that each build records its own revision. Local edits
+# get a hash of the diff appended, so different uncommitted states do not
+# share one "-dirty" id. The header is only rewritten when it changes.
+#
+# cmake -DSOURCE_DIR=<repo> -DOUTPUT=<header> -P obj_build_hash.cmake
+
+execute_process(COMMAND git describe --always --dirty
+	WORKING_DIRECTORY ${SOURCE_DIR}
+	OUTPUT_VARIABLE OBJ_BUILD_HASH
+	OUTPUT_STRIP_TRAILING_WHITESPACE
+	ERROR_QUIET
+)
+if (OBJ_BUILD_HASH MATCHES "-dirty$")
+	execute_process(COMMAND git diff HEAD
+		WORKING_DIRECTORY ${SOURCE_DIR}
+		OUTPUT_VARIABLE OBJ_BUILD_DIFF
+		ERROR_QUIET
+	)
+	string(SHA1 OBJ_BUILD_DIFF_HASH "${OBJ_BUILD_DIFF}")
+	string(SUBSTRING "${OBJ_BUILD_DIFF_HASH}" 0 8 OBJ_BUILD_DIFF_HASH)
+	set(OBJ_BUILD_HASH "${OBJ_BUILD_HASH}-${OBJ_BUILD_DIFF_HASH}")
+endif()
+
+set(OBJ_BUILD_HASH_HEADER "#define OBJ_BUILD_HASH \"${OBJ_BUILD_HASH}\"\n")
+if (EXISTS ${OUTPUT})
+	file(READ ${OUTPUT} OBJ_BUILD_HASH_OLD)
+endif()
+if (NOT OBJ_BUILD_HASH_OLD STREQUAL OBJ_BUILD_HASH_HEADER)
+	file(WRITE ${OUTPUT} "${OBJ_BUILD_HASH_HEADER}")
+endif()
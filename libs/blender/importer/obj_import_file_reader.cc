@@ -369,6 +369,17 @@ OBJParser::OBJParser(const OBJImportParams &import_params, size_t read_buffer_si
   }
 }
 
+OBJParser::OBJParser(const OBJImportParams &import_params,
+                     StringRef buffer,
+                     size_t read_buffer_size = 64 * 1024)
+    : import_params_(import_params),
+      obj_file_(nullptr),
+      memory_buffer_(buffer),
+      from_memory_(true),
+      read_buffer_size_(read_buffer_size)
+{
+}
+
 OBJParser::~OBJParser()
 {
   if (obj_file_) {
@@ -376,6 +387,35 @@ OBJParser::~OBJParser()
   }
 }
 
+size_t OBJParser::read_chunk(char *dst, size_t size)
+{
+  if (!from_memory_) {
+    return fread(dst, 1, size, obj_file_);
+  }
+  size = std::min(size, (size_t)memory_buffer_.size() - memory_offset_);
+  memcpy(dst, memory_buffer_.data() + memory_offset_, size);
+  memory_offset_ += size;
+  return size;
+}
+
+void OBJParser::set_geometry_observer(std::function<void(const Geometry &)> observer)
+{
+  geometry_observer_ = std::move(observer);
+}
+
+void OBJParser::notify_complete_geometries(const Vector<std::unique_ptr<Geometry>> &all_geometries,
+                                           bool at_end)
+{
+  if (!geometry_observer_) {
+    return;
+  }
+  /* Elements can only be added to the last geometry, until the file ends. */
+  const int64_t complete = at_end ? all_geometries.size() : all_geometries.size() - 1;
+  for (; observed_geometries_ < complete; observed_geometries_++) {
+    geometry_observer_(*all_geometries[observed_geometries_]);
+  }
+}
+
 /* If line starts with keyword followed by whitespace, returns true and drops it from the line. */
 static bool parse_keyword(const char *&p, const char *end, StringRef keyword)
 {
@@ -398,7 +438,7 @@ static bool parse_keyword(const char *&p, const char *end, StringRef keyword)
 void OBJParser::parse(Vector<std::unique_ptr<Geometry>> &r_all_geometries,
                       GlobalVertices &r_global_vertices)
 {
-  if (!obj_file_) {
+  if (!obj_file_ && !from_memory_) {
     return;
   }
 
@@ -422,7 +462,7 @@ void OBJParser::parse(Vector<std::unique_ptr<Geometry>> &r_all_geometries,
   size_t line_number = 0;
   while (true) {
     /* Read a chunk of input from the file. */
-    size_t bytes_read = fread(buffer.data() + buffer_offset, 1, read_buffer_size_, obj_file_);
+    size_t bytes_read = read_chunk(buffer.data() + buffer_offset, read_buffer_size_);
     if (bytes_read == 0 && buffer_offset == 0) {
       break; /* No more data to read. */
     }
@@ -509,6 +549,7 @@ void OBJParser::parse(Vector<std::unique_ptr<Geometry>> &r_all_geometries,
                                     r_global_vertices,
                                     r_all_geometries,
                                     offsets);
+        notify_complete_geometries(r_all_geometries, false);
       }
       /* Groups. */
       else if (parse_keyword(p, end, "g")) {
@@ -547,6 +588,7 @@ void OBJParser::parse(Vector<std::unique_ptr<Geometry>> &r_all_geometries,
       else if (parse_keyword(p, end, "cstype")) {
         curr_geom = geom_set_curve_type(
             curr_geom, p, end, r_global_vertices, state_group_name, offsets, r_all_geometries);
+        notify_complete_geometries(r_all_geometries, false);
       }
       else if (parse_keyword(p, end, "deg")) {
         geom_set_curve_degree(curr_geom, p, end);
@@ -572,6 +614,7 @@ void OBJParser::parse(Vector<std::unique_ptr<Geometry>> &r_all_geometries,
     buffer_offset = left_size;
   }
 
+  notify_complete_geometries(r_all_geometries, true);
   add_default_mtl_library();
 }
 
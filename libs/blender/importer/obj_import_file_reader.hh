@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <functional>
 #include <stdio.h>
 #include "IO_wavefront_obj.h"
 #include "obj_import_objects.hh"
@@ -19,14 +20,25 @@ class OBJParser {
  private:
   const OBJImportParams &import_params_;
   FILE *obj_file_;
+  /** OBJ file contents when parsing from memory instead of #obj_file_. */
+  StringRef memory_buffer_;
+  size_t memory_offset_ = 0;
+  bool from_memory_ = false;
   Vector<std::string> mtl_libraries_;
   size_t read_buffer_size_;
+  std::function<void(const Geometry &)> geometry_observer_;
+  int64_t observed_geometries_ = 0;
 
  public:
   /**
    * Open OBJ file at the path given in import parameters.
    */
   OBJParser(const OBJImportParams &import_params, size_t read_buffer_size);
+  /**
+   * Parse OBJ file contents already in memory; the buffer has to outlive the parser.
+   * The file path in import parameters is still used to find material libraries.
+   */
+  OBJParser(const OBJImportParams &import_params, StringRef buffer, size_t read_buffer_size);
   ~OBJParser();
 
   /**
@@ -39,8 +51,18 @@ class OBJParser {
    * Return a list of all material library filepaths referenced by the OBJ file.
    */
   Span<std::string> mtl_libraries() const;
+  /**
+   * Set a function that #parse calls with each geometry as soon as it is complete,
+   * i.e. when the next object starts or the file ends.
+   */
+  void set_geometry_observer(std::function<void(const Geometry &)> observer);
 
  private:
+  /** Read up to `size` bytes of the OBJ file into `dst`, returning how many were read. */
+  size_t read_chunk(char *dst, size_t size);
+  /** Pass the geometries that got completed since the last call to the observer. */
+  void notify_complete_geometries(const Vector<std::unique_ptr<Geometry>> &all_geometries,
+                                  bool at_end);
   void add_mtl_library(StringRef path);
   void add_default_mtl_library();
 };
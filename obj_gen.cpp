@@ -0,0 +1,120 @@
+#include "obj_gen.h"
+
+#include <stdlib.h>
+
+static void print_usage()
+{
+    printf("USAGE: obj_gen [options] <output obj file>\n");
+    printf("Writes a deterministic synthetic .obj file (and a .mtl next to it when it has materials).\n");
+    printf("  --seed N          random seed (default 1)\n");
+    printf("  --size-mb N       scale vertex/uv/normal/face counts so that the file is about N MB (10^6 bytes)\n");
+    printf("  --vertices N      vertex positions (default 100000)\n");
+    printf("  --uvs N           texture coordinates (default: same as vertices)\n");
+    printf("  --normals N       normals (default: same as vertices)\n");
+    printf("  --faces N         faces (default: same as vertices)\n");
+    printf("  --objects N       objects (default 1)\n");
+    printf("  --groups N        groups per object (default 0)\n");
+    printf("  --materials N     materials (default 1)\n");
+    printf("  --arity N[-M]     vertices per face, or a random range (default 4)\n");
+    printf("  --negative        use negative (relative) indices\n");
+    printf("  --colors          add xyzrgb vertex colors\n");
+    printf("  --continuations   split face lines with '\\' line continuations\n");
+    printf("  --continue-all    with --continuations, split the v/vt/vn lines too\n");
+    printf("  --crlf            \\r\\n line endings\n");
+    printf("  --comments N      N comment lines after every line\n");
+    printf("  --object-size N   objects of N vertices each, instead of --objects\n");
+    printf("  --shape NAME      pathological file preset, scaled to --size-mb (default 10):\n                   ");
+    for (const char* shape : kObjGenShapes)
+        printf(" %s", shape);
+    printf("\n");
+}
+
+static bool parse_options(int argc, const char* argv[], ObjGenParams& p, double& size_mb, const char*& shape, const char*& path)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (strcmp(arg, "--seed") == 0 && has_value)
+            p.seed = strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(arg, "--size-mb") == 0 && has_value)
+            size_mb = atof(argv[++i]);
+        else if (strcmp(arg, "--vertices") == 0 && has_value)
+            p.vertices = atoll(argv[++i]);
+        else if (strcmp(arg, "--uvs") == 0 && has_value)
+            p.uvs = atoll(argv[++i]);
+        else if (strcmp(arg, "--normals") == 0 && has_value)
+            p.normals = atoll(argv[++i]);
+        else if (strcmp(arg, "--faces") == 0 && has_value)
+            p.faces = atoll(argv[++i]);
+        else if (strcmp(arg, "--objects") == 0 && has_value)
+            p.objects = atoi(argv[++i]);
+        else if (strcmp(arg, "--groups") == 0 && has_value)
+            p.groups = atoi(argv[++i]);
+        else if (strcmp(arg, "--materials") == 0 && has_value)
+            p.materials = atoi(argv[++i]);
+        else if (strcmp(arg, "--arity") == 0 && has_value)
+        {
+            const char* val = argv[++i];
+            p.arity_min = p.arity_max = atoi(val);
+            if (const char* dash = strchr(val, '-'))
+                p.arity_max = atoi(dash + 1);
+        }
+        else if (strcmp(arg, "--negative") == 0)
+            p.negative_indices = true;
+        else if (strcmp(arg, "--colors") == 0)
+            p.vertex_colors = true;
+        else if (strcmp(arg, "--continuations") == 0)
+            p.line_continuations = true;
+        else if (strcmp(arg, "--continue-all") == 0)
+            p.continue_all_lines = true;
+        else if (strcmp(arg, "--crlf") == 0)
+            p.crlf = true;
+        else if (strcmp(arg, "--comments") == 0 && has_value)
+            p.comment_lines = atoi(argv[++i]);
+        else if (strcmp(arg, "--object-size") == 0 && has_value)
+            p.vertices_per_object = atoll(argv[++i]);
+        else if (strcmp(arg, "--shape") == 0 && has_value)
+            shape = argv[++i];
+        else if (arg[0] == '-' && arg[1] == '-')
+            return false;
+        else
+            path = arg;
+    }
+    return path != nullptr && p.vertices > 0 && p.arity_min >= 3 && p.arity_max >= p.arity_min;
+}
+
+int main(int argc, const char* argv[])
+{
+    ObjGenParams p;
+    double size_mb = 0;
+    const char* shape = nullptr;
+    const char* path = nullptr;
+    if (!parse_options(argc, argv, p, size_mb, shape, path))
+    {
+        print_usage();
+        return -1;
+    }
+    if (shape != nullptr)
+    {
+        if (!obj_gen_apply_shape(p, shape, (uint64_t)((size_mb > 0 ? size_mb : 10) * kObjGenMB)))
+        {
+            print_usage();
+            return -1;
+        }
+    }
+    else if (size_mb > 0)
+        obj_gen_scale_to_size(p, (uint64_t)(size_mb * kObjGenMB));
+
+    uint64_t bytes = obj_gen_write_files(path, p);
+    if (bytes == 0)
+    {
+        printf("Can't write the file!\n");
+        return 1;
+    }
+    printf("%s: %.1f MB, v=%lld vt=%lld vn=%lld f=%lld o=%i mat=%i\n", path, (double)bytes / kObjGenMB,
+        (long long)p.vertices, (long long)obj_gen_resolve_count(p.uvs, p.vertices),
+        (long long)obj_gen_resolve_count(p.normals, p.vertices), (long long)obj_gen_resolve_count(p.faces, p.vertices),
+        p.vertices_per_object > 0 ? (int)std::max<int64_t>(1, p.vertices / p.vertices_per_object) : p.objects, p.materials);
+    return 0;
+}
@@ -0,0 +1,356 @@
+#pragma once
+
+// Deterministic synthetic .obj file generator, used by the obj_gen tool.
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+
+// Sizes in MB (obj_gen --size-mb, the tester's --corpus-mb and --ladder-mb)
+// are 10^6 bytes, the same MB as in the tester's throughput numbers.
+static const uint64_t kObjGenMB = 1000000;
+
+struct ObjGenParams
+{
+    uint64_t seed = 1;
+    int64_t vertices = 100000;
+    int64_t uvs = -1; // -1: same as vertices
+    int64_t normals = -1; // -1: same as vertices
+    int64_t faces = -1; // -1: same as vertices
+    int objects = 1;
+    int64_t vertices_per_object = 0; // >0: as many objects as it takes, overrides `objects`
+    int groups = 0; // per object; 0 emits no `g` lines
+    int materials = 1; // 0 emits no material library
+    int arity_min = 4; // vertices per face, picked randomly in [arity_min, arity_max]
+    int arity_max = 4;
+    bool negative_indices = false; // relative (negative) indices in faces
+    bool vertex_colors = false; // `v x y z r g b` vertex colors
+    bool line_continuations = false; // split face lines in two with a `\` continuation
+    bool continue_all_lines = false; // with line_continuations, also split v/vt/vn lines
+    bool crlf = false; // \r\n line endings
+    int comment_lines = 0; // `#` comment lines after every line
+};
+
+// Shapes of pathological (but valid) files that have been slow in some
+// parsers, for the obj_gen --shape option and the tester corpus mode.
+static const char* kObjGenShapes[] = {
+    "baseline", // defaults, to compare the others with
+    "tiny-objects", // tens of thousands of `o` blocks of a few faces each
+    "big-ngons", // 1000-vertex faces
+    "comments", // mostly comment lines
+    "crlf", // \r\n line endings
+    "continuations", // `\` continuations on every line
+    "negative", // negative (relative) indices
+    "long-lines", // face lines just under the 64 KB line limit of the Blender parser
+};
+
+// Output sink that counts the bytes written; with a null file it only counts.
+struct ObjGenWriter
+{
+    FILE* file = nullptr;
+    uint64_t bytes = 0;
+    bool crlf = false;
+    int comment_lines = 0;
+
+    void print(const char* format, ...)
+    {
+        char buf[256];
+        va_list args;
+        va_start(args, format);
+        int len = vsnprintf(buf, sizeof(buf), format, args);
+        va_end(args);
+        if (len < 0)
+            return;
+        if (len >= (int)sizeof(buf))
+            len = sizeof(buf) - 1;
+        write(buf, len);
+    }
+    void write(const char* str, size_t len)
+    {
+        if (!crlf && comment_lines == 0)
+        {
+            write_raw(str, len);
+            return;
+        }
+        // line endings get expanded as configured
+        while (const char* eol = (const char*)memchr(str, '\n', len))
+        {
+            write_raw(str, eol - str);
+            end_line();
+            // a comment after a `\` would become part of the continued line
+            const bool continued = eol > str && eol[-1] == '\\';
+            for (int i = 0; i < (continued ? 0 : comment_lines); ++i)
+            {
+                static const char comment[] = "# a comment line that every parser has to skip";
+                write_raw(comment, sizeof(comment) - 1);
+                end_line();
+            }
+            len -= eol + 1 - str;
+            str = eol + 1;
+        }
+        write_raw(str, len);
+    }
+    void end_line() { write_raw(crlf ? "\r\n" : "\n", crlf ? 2 : 1); }
+    void write_raw(const char* str, size_t len)
+    {
+        if (file)
+            fwrite(str, 1, len, file);
+        bytes += len;
+    }
+};
+
+// splitmix64
+struct ObjGenRandom
+{
+    uint64_t state;
+
+    explicit ObjGenRandom(uint64_t seed) : state(seed) {}
+    uint64_t next()
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    float next_float(float lo, float hi) { return lo + (hi - lo) * (float)((next() >> 40) * (1.0 / 16777216.0)); }
+    int next_int(int lo, int hi) { return lo + (int)(next() % (uint64_t)(hi - lo + 1)); }
+};
+
+static int64_t obj_gen_resolve_count(int64_t count, int64_t vertices)
+{
+    return count < 0 ? vertices : count;
+}
+
+static void obj_gen_write_index(ObjGenWriter& w, int64_t index, int64_t emitted, bool negative)
+{
+    // `index` is zero based, `emitted` is how many elements of that kind are in the file so far
+    if (negative)
+        w.print("%lld", (long long)(index - emitted));
+    else
+        w.print("%lld", (long long)(index + 1));
+}
+
+// Writes the .obj data into the writer. The material library name is referenced
+// with `mtllib` when there are materials.
+static void obj_gen_write_obj(ObjGenWriter& w, const ObjGenParams& p, const char* mtllib_name)
+{
+    ObjGenRandom rnd(p.seed);
+    const int64_t vertex_total = p.vertices;
+    const int64_t uv_total = obj_gen_resolve_count(p.uvs, p.vertices);
+    const int64_t normal_total = obj_gen_resolve_count(p.normals, p.vertices);
+    const int64_t face_total = obj_gen_resolve_count(p.faces, p.vertices);
+    const int64_t per_object = p.vertices_per_object;
+    const int objects = per_object > 0 ? (int)std::max<int64_t>(1, vertex_total / per_object) : p.objects < 1 ? 1 : p.objects;
+    const int arity_min = p.arity_min < 3 ? 3 : p.arity_min;
+    const int arity_max = p.arity_max < arity_min ? arity_min : p.arity_max;
+
+    w.crlf = p.crlf;
+    w.comment_lines = p.comment_lines;
+    w.print("# obj_gen seed=%llu\n", (unsigned long long)p.seed);
+    if (p.materials > 0 && mtllib_name != nullptr)
+        w.print("mtllib %s\n", mtllib_name);
+
+    const bool split = p.line_continuations && p.continue_all_lines;
+    int64_t v_emitted = 0, vt_emitted = 0, vn_emitted = 0;
+    int64_t chunk_index = 0;
+    for (int o = 0; o < objects; ++o)
+    {
+        const int64_t v_count = vertex_total * (o + 1) / objects - vertex_total * o / objects;
+        const int64_t vt_count = uv_total * (o + 1) / objects - uv_total * o / objects;
+        const int64_t vn_count = normal_total * (o + 1) / objects - normal_total * o / objects;
+        const int64_t f_count = face_total * (o + 1) / objects - face_total * o / objects;
+
+        w.print("o object%i\n", o);
+        for (int64_t i = 0; i < v_count; ++i)
+        {
+            float x = rnd.next_float(-1, 1), y = rnd.next_float(-1, 1), z = rnd.next_float(-1, 1);
+            if (p.vertex_colors)
+                w.print(split ? "v %.6f \\\n%.6f %.6f %.4f %.4f %.4f\n" : "v %.6f %.6f %.6f %.4f %.4f %.4f\n", x, y, z,
+                    rnd.next_float(0, 1), rnd.next_float(0, 1), rnd.next_float(0, 1));
+            else
+                w.print(split ? "v %.6f \\\n%.6f %.6f\n" : "v %.6f %.6f %.6f\n", x, y, z);
+        }
+        for (int64_t i = 0; i < vt_count; ++i)
+        {
+            float u = rnd.next_float(0, 1), v = rnd.next_float(0, 1);
+            w.print(split ? "vt %.6f \\\n%.6f\n" : "vt %.6f %.6f\n", u, v);
+        }
+        for (int64_t i = 0; i < vn_count; ++i)
+        {
+            float x = rnd.next_float(-1, 1), y = rnd.next_float(-1, 1), z = rnd.next_float(-1, 1);
+            w.print(split ? "vn %.4f \\\n%.4f %.4f\n" : "vn %.4f %.4f %.4f\n", x, y, z);
+        }
+        v_emitted += v_count;
+        vt_emitted += vt_count;
+        vn_emitted += vn_count;
+
+        // faces index into the vertex data of this object, or everything
+        // emitted so far if the object got none of a kind
+        const int64_t v_base = v_count > 0 ? v_emitted - v_count : 0;
+        const int64_t v_range = v_count > 0 ? v_count : v_emitted;
+        const int64_t vt_base = vt_count > 0 ? vt_emitted - vt_count : 0;
+        const int64_t vt_range = vt_count > 0 ? vt_count : vt_emitted;
+        const int64_t vn_base = vn_count > 0 ? vn_emitted - vn_count : 0;
+        const int64_t vn_range = vn_count > 0 ? vn_count : vn_emitted;
+        if (v_range == 0)
+            continue;
+
+        const int chunks = p.groups > 0 ? p.groups : 1;
+        for (int c = 0; c < chunks; ++c, ++chunk_index)
+        {
+            if (p.groups > 0)
+                w.print("g group%i_%i\n", o, c);
+            if (p.materials > 0)
+                w.print("usemtl material%i\n", (int)(chunk_index % p.materials));
+            const int64_t f_begin = f_count * c / chunks;
+            const int64_t f_end = f_count * (c + 1) / chunks;
+            for (int64_t f = f_begin; f < f_end; ++f)
+            {
+                const int arity = arity_min == arity_max ? arity_min : rnd.next_int(arity_min, arity_max);
+                w.write("f", 1);
+                for (int k = 0; k < arity; ++k)
+                {
+                    if (p.line_continuations && k == arity / 2)
+                        w.write(" \\\n", 3);
+                    else
+                        w.write(" ", 1);
+                    obj_gen_write_index(w, v_base + (f + k) % v_range, v_emitted, p.negative_indices);
+                    if (vt_range > 0 || vn_range > 0)
+                        w.write("/", 1);
+                    if (vt_range > 0)
+                        obj_gen_write_index(w, vt_base + (f + k) % vt_range, vt_emitted, p.negative_indices);
+                    if (vn_range > 0)
+                    {
+                        w.write("/", 1);
+                        obj_gen_write_index(w, vn_base + (f + k) % vn_range, vn_emitted, p.negative_indices);
+                    }
+                }
+                w.write("\n", 1);
+            }
+        }
+    }
+}
+
+static void obj_gen_write_mtl(ObjGenWriter& w, const ObjGenParams& p)
+{
+    ObjGenRandom rnd(p.seed ^ 0x6D746Cull);
+    for (int i = 0; i < p.materials; ++i)
+    {
+        w.print("newmtl material%i\n", i);
+        w.print("Kd %.3f %.3f %.3f\n", rnd.next_float(0, 1), rnd.next_float(0, 1), rnd.next_float(0, 1));
+        w.print("Ks 0.5 0.5 0.5\nNs 100\n\n");
+    }
+}
+
+// Scales the vertex/uv/normal/face counts (keeping their ratios) so that the
+// generated .obj file is close to the given size in bytes.
+static void obj_gen_scale_to_size(ObjGenParams& p, uint64_t target_bytes)
+{
+    // measure the bytes per vertex of a small sample with the same settings
+    ObjGenParams sample = p;
+    const int64_t sample_vertices = 10000;
+    double scale = (double)sample_vertices / (p.vertices > 0 ? p.vertices : 1);
+    sample.vertices = sample_vertices;
+    sample.uvs = (int64_t)(obj_gen_resolve_count(p.uvs, p.vertices) * scale);
+    sample.normals = (int64_t)(obj_gen_resolve_count(p.normals, p.vertices) * scale);
+    sample.faces = (int64_t)(obj_gen_resolve_count(p.faces, p.vertices) * scale);
+    ObjGenWriter counter;
+    obj_gen_write_obj(counter, sample, "x.mtl");
+    double bytes_per_vertex = (double)counter.bytes / sample_vertices;
+
+    int64_t vertices = (int64_t)(target_bytes / bytes_per_vertex);
+    if (vertices < 1)
+        vertices = 1;
+    double ratio = (double)vertices / (p.vertices > 0 ? p.vertices : 1);
+    p.uvs = (int64_t)(obj_gen_resolve_count(p.uvs, p.vertices) * ratio);
+    p.normals = (int64_t)(obj_gen_resolve_count(p.normals, p.vertices) * ratio);
+    p.faces = (int64_t)(obj_gen_resolve_count(p.faces, p.vertices) * ratio);
+    p.vertices = vertices;
+}
+
+// Sets up the parameters for one of kObjGenShapes, with a file size close to
+// target_bytes. Returns false for unknown shapes.
+static bool obj_gen_apply_shape(ObjGenParams& p, const char* shape, uint64_t target_bytes)
+{
+    if (strcmp(shape, "tiny-objects") == 0)
+        p.vertices_per_object = 4;
+    else if (strcmp(shape, "big-ngons") == 0)
+    {
+        p.arity_min = p.arity_max = 1000;
+        p.faces = p.vertices / 250;
+    }
+    else if (strcmp(shape, "comments") == 0)
+        p.comment_lines = 4;
+    else if (strcmp(shape, "crlf") == 0)
+        p.crlf = true;
+    else if (strcmp(shape, "continuations") == 0)
+        p.line_continuations = p.continue_all_lines = true;
+    else if (strcmp(shape, "negative") == 0)
+        p.negative_indices = true;
+    else if (strcmp(shape, "long-lines") == 0)
+    {
+        p.arity_min = p.arity_max = 3000;
+        p.faces = p.vertices / 750;
+    }
+    else if (strcmp(shape, "baseline") != 0)
+        return false;
+    obj_gen_scale_to_size(p, target_bytes);
+
+    if (strcmp(shape, "long-lines") == 0)
+    {
+        // a face corner is " v/vt/vn", with as many digits as the largest
+        // index, which is about face count + arity; aim for lines between
+        // 56 and 63 KB
+        const int64_t corners = p.faces * p.arity_min;
+        int64_t max_index = p.vertices;
+        for (int step = 0; step < 3; ++step)
+        {
+            int digits = 1;
+            for (int64_t n = max_index; n >= 10; n /= 10)
+                ++digits;
+            const int corner_bytes = 3 * digits + 3;
+            p.arity_max = 63 * 1024 / corner_bytes;
+            p.arity_min = 56 * 1024 / corner_bytes;
+            p.faces = std::max<int64_t>(1, corners / ((p.arity_min + p.arity_max) / 2));
+            max_index = std::min<int64_t>(p.vertices, p.faces + p.arity_max);
+        }
+    }
+    return true;
+}
+
+// Writes the .obj file, and a .mtl file next to it when there are materials.
+// Returns the number of .obj bytes written, or 0 on failure.
+static uint64_t obj_gen_write_files(const char* obj_path, const ObjGenParams& p)
+{
+    std::string mtl_path = obj_path;
+    size_t dot = mtl_path.rfind('.');
+    size_t slash = mtl_path.find_last_of("/\\");
+    if (dot != std::string::npos && (slash == std::string::npos || dot > slash))
+        mtl_path.resize(dot);
+    mtl_path += ".mtl";
+    std::string mtl_name = slash == std::string::npos ? mtl_path : mtl_path.substr(mtl_path.find_last_of("/\\") + 1);
+
+    FILE* f = fopen(obj_path, "wb");
+    if (!f)
+        return 0;
+    setvbuf(f, nullptr, _IOFBF, 1 << 20);
+    ObjGenWriter w;
+    w.file = f;
+    obj_gen_write_obj(w, p, mtl_name.c_str());
+    bool ok = fclose(f) == 0;
+
+    if (p.materials > 0)
+    {
+        FILE* fm = fopen(mtl_path.c_str(), "wb");
+        if (!fm)
+            return 0;
+        ObjGenWriter wm;
+        wm.file = fm;
+        obj_gen_write_mtl(wm, p);
+        ok &= fclose(fm) == 0;
+    }
+    return ok ? w.bytes : 0;
+}
@@ -10,15 +10,68 @@
 #include "libs/assimp/include/assimp/Importer.hpp"
 #include "libs/assimp/include/assimp/scene.h"
 #include "libs/assimp/include/assimp/postprocess.h"
+#include "libs/assimp/include/assimp/DefaultIOSystem.h"
+#include "libs/assimp/include/assimp/MemoryIOWrapper.h"
 
 #include "libs/blender/importer/obj_importer.hh"
+#include "libs/blender/importer/obj_import_file_reader.hh"
+#include "libs/blender/MEM_guardedalloc.h"
 
 #include "libs/OpenSceneGraph-min/obj.h"
 
 #include "libs/xxHash/xxhash.h"
 
+#include "obj_gen.h"
+
+#include <errno.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <filesystem>
+#include <istream>
+#include <string>
+#include <new>
+#include <random>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/utsname.h>
+#include <sys/wait.h>
+#endif
+#if defined(OBJ_ALLOC_PROFILE) && defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#ifdef __linux__
+#include <linux/magic.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <sys/vfs.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+#ifdef __APPLE__
+#include <mach/mach.h>
+#include <sys/sysctl.h>
+#endif
 
 static std::chrono::steady_clock::time_point get_time()
 {
@@ -30,296 +83,4074 @@ static double get_duration(std::chrono::steady_clock::time_point since)
     return dur.count();
 }
 
-struct ObjParseStats
+// Drops the file from the OS page cache, so that the next read of it
+// comes from the storage device. Only supported on Linux.
+static bool evict_file_cache(const char* filename)
 {
-    bool ok = false;
-    double time = -1;
-    int vertex_count = -1;
-    int normal_count = -1;
-    int uv_count = -1;
-    int shape_count = -1;
-    int material_count = -1;
-    uint32_t vertex_hash = 0;
-    uint32_t normal_hash = 0;
-    uint32_t uv_hash = 0;
+    #ifdef __linux__
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return false;
+    fsync(fd);
+    bool ok = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+    close(fd);
+    return ok;
+    #else
+    return false;
+    #endif
+}
 
-    void print(const char* title) const
+// Fraction (0..1) of the file pages that are resident in the OS page
+// cache, or -1 if that can not be determined.
+static double get_file_cache_residency(const char* filename)
+{
+    #ifdef __linux__
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
     {
-        printf("%-18s ok=%i t=%6.2f s v=%8i vn=%8i vt=%8i o=%5i mat=%4i hash: v=%08x vn=%08x vt=%08x\n",
-            title, ok, time, vertex_count, normal_count, uv_count, shape_count, material_count,
-            vertex_hash, normal_hash, uv_hash);
+        close(fd);
+        return -1;
     }
-};
-
-static char* read_file(const char* filename, size_t* outSize = nullptr)
-{
-    FILE* f = fopen(filename, "rb");
-    if (!f)
-        return nullptr;
-    fseek(f, 0, SEEK_END);
-    #ifdef _MSC_VER
-    auto size = _ftelli64(f);
+    size_t size = (size_t)st.st_size;
+    void* map = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return -1;
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    size_t pages = (size + page_size - 1) / page_size;
+    std::vector<unsigned char> resident(pages);
+    double res = -1;
+    if (mincore(map, size, resident.data()) == 0)
+    {
+        size_t count = 0;
+        for (unsigned char r : resident)
+            count += r & 1;
+        res = (double)count / pages;
+    }
+    munmap(map, size);
+    return res;
     #else
-    auto size = ftello(f);
+    return -1;
     #endif
-    fseek(f, 0, SEEK_SET);
-    char* buf = new char[size];
-    fread(buf, 1, size, f);
-    fclose(f);
-    if (outSize != nullptr)
-        *outSize = size;
-    return buf;
 }
 
-
-static void parse_tinyobjloader(const char* filename)
+// Process resident memory, in bytes; -1 when not available on the platform.
+//
+// On Linux the high-water mark can be reset between parsers (via
+// /proc/self/clear_refs); on Windows and macOS the peak is over the whole
+// process lifetime.
+static void reset_peak_memory()
 {
-    ObjParseStats res;
-    auto t0 = get_time();
-
-    using namespace tinyobj;
-    attrib_t attrib;
-    std::vector<shape_t> shapes;
-    std::vector<material_t> materials;
-    std::string err;
-    std::string warn;
-    const char* baseEnd1 = strrchr(filename, '/');
-    const char* baseEnd2 = strrchr(filename, '\\');
-    std::string baseDir = std::string(filename, baseEnd1 > baseEnd2 ? baseEnd1 : baseEnd2);
-    res.ok = LoadObj(&attrib, &shapes, &materials, &warn, &err, filename, baseDir.c_str(), false, false);
-
-    res.time = get_duration(t0);
-
-    if (res.ok)
+    #ifdef __linux__
+    FILE* f = fopen("/proc/self/clear_refs", "w");
+    if (f)
     {
-        res.vertex_count = (int)(attrib.vertices.size() / 3);
-        res.normal_count = (int)(attrib.normals.size() / 3);
-        res.uv_count = (int)(attrib.texcoords.size() / 2);
-        res.vertex_hash = XXH3_64bits(attrib.vertices.data(), attrib.vertices.size() * 4) & 0xFFFFFFFF;
-        res.normal_hash = XXH3_64bits(attrib.normals.data(), attrib.normals.size() * 4) & 0xFFFFFFFF;
-        res.uv_hash = XXH3_64bits(attrib.texcoords.data(), attrib.texcoords.size() * 4) & 0xFFFFFFFF;
-        res.shape_count = (int)shapes.size();
-        res.material_count = (int)materials.size();
+        fputs("5", f);
+        fclose(f);
     }
-
-    res.print("tinyobjloader");
+    #endif
 }
 
-static void parse_tinyobjloader_opt(const char* filename)
+#ifdef __linux__
+static int64_t read_proc_status_kb(const char* key)
 {
-    ObjParseStats res;
-    auto t0 = get_time();
-
-    using namespace tinyobj_opt;
-    attrib_t attrib;
-    std::vector<shape_t> shapes;
-    std::vector<material_t> materials;
-    size_t filesize = 0;
-    char* filebuf = read_file(filename, &filesize);
-    LoadOption options;
-    options.triangulate = false;
-    res.ok = parseObj(&attrib, &shapes, &materials, filebuf, filesize, options);
-    delete[] filebuf;
-
-    res.time = get_duration(t0);
-
-    if (res.ok)
+    FILE* f = fopen("/proc/self/status", "r");
+    if (!f)
+        return -1;
+    int64_t res = -1;
+    char line[256];
+    size_t keylen = strlen(key);
+    while (fgets(line, sizeof(line), f))
     {
-        res.vertex_count = (int)(attrib.vertices.size() / 3);
-        res.normal_count = (int)(attrib.normals.size() / 3);
-        res.uv_count = (int)(attrib.texcoords.size() / 2);
-        res.vertex_hash = XXH3_64bits(attrib.vertices.data(), attrib.vertices.size() * 4) & 0xFFFFFFFF;
-        res.normal_hash = XXH3_64bits(attrib.normals.data(), attrib.normals.size() * 4) & 0xFFFFFFFF;
-        res.uv_hash = XXH3_64bits(attrib.texcoords.data(), attrib.texcoords.size() * 4) & 0xFFFFFFFF;
-        res.shape_count = (int)shapes.size();
-        res.material_count = (int)materials.size();
+        if (strncmp(line, key, keylen) == 0 && line[keylen] == ':')
+        {
+            res = atoll(line + keylen + 1);
+            break;
+        }
     }
-
-    res.print("tinyobjloader_opt");
+    fclose(f);
+    return res;
 }
+#endif
 
-static void parse_fast_obj(const char* filename)
+static int64_t get_current_memory()
 {
-    ObjParseStats res;
-    auto t0 = get_time();
+    #ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+        return pmc.WorkingSetSize;
+    return -1;
+    #elif defined(__APPLE__)
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) == KERN_SUCCESS)
+        return info.resident_size;
+    return -1;
+    #elif defined(__linux__)
+    int64_t kb = read_proc_status_kb("VmRSS");
+    return kb < 0 ? -1 : kb * 1024;
+    #else
+    return -1;
+    #endif
+}
 
-    fastObjMesh* m = fast_obj_read(filename);
-    res.ok = m != nullptr;
+static int64_t get_peak_memory()
+{
+    #ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+        return pmc.PeakWorkingSetSize;
+    return -1;
+    #elif defined(__APPLE__)
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) == KERN_SUCCESS)
+        return info.resident_size_max;
+    return -1;
+    #elif defined(__linux__)
+    int64_t kb = read_proc_status_kb("VmHWM");
+    return kb < 0 ? -1 : kb * 1024;
+    #else
+    return -1;
+    #endif
+}
 
-    res.time = get_duration(t0);
+// Hardware / OS event counts of a load, from Linux perf_event_open; -1 when
+// counting is disabled, or not allowed by the kernel or not supported by the CPU.
+struct PerfCounts
+{
+    int64_t cycles = -1;
+    int64_t instructions = -1;
+    int64_t l1d_misses = -1; // L1 data cache read misses
+    int64_t llc_misses = -1; // last level cache read misses
+    int64_t branch_misses = -1;
+    int64_t page_faults = -1;
+    int64_t context_switches = -1;
 
-    if (res.ok)
+    double ipc() const
     {
-        res.vertex_count = m->position_count - 1;
-        res.normal_count = m->normal_count - 1;
-        res.uv_count = m->texcoord_count - 1;
-        res.vertex_hash = XXH3_64bits(m->positions + 3, (m->position_count-1) * 12) & 0xFFFFFFFF;
-        res.normal_hash = XXH3_64bits(m->normals + 3, (m->normal_count-1) * 12) & 0xFFFFFFFF;
-        res.uv_hash = XXH3_64bits(m->texcoords + 2, (m->texcoord_count-1) * 8) & 0xFFFFFFFF;
-        res.shape_count = m->group_count;
-        res.material_count = m->material_count;
-        fast_obj_destroy(m);
+        return cycles > 0 && instructions >= 0 ? (double)instructions / cycles : -1;
     }
+};
 
-    res.print("fast_obj");
-}
+static bool s_perf_counters_enabled = false;
 
-static void parse_rapidobj(const char* filename)
+#ifdef __linux__
+struct PerfEventDesc
 {
-    ObjParseStats res;
-    auto t0 = get_time();
+    uint32_t type;
+    uint64_t config;
+    int64_t PerfCounts::*value;
+};
 
-    auto m = rapidobj::ParseFile(filename);
-    res.ok = !m.error;
+static const PerfEventDesc kPerfEvents[] =
+{
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, &PerfCounts::cycles },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, &PerfCounts::instructions },
+    { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16), &PerfCounts::l1d_misses },
+    { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16), &PerfCounts::llc_misses },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, &PerfCounts::branch_misses },
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, &PerfCounts::page_faults },
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, &PerfCounts::context_switches },
+};
+static const int kPerfEventCount = sizeof(kPerfEvents) / sizeof(kPerfEvents[0]);
 
-    res.time = get_duration(t0);
+// Counter file descriptors, opened on first use in the process that does the
+// loads (-1: could not be opened). They are inherited by threads created
+// afterwards, so the worker threads of the multithreaded parsers are counted too.
+static int s_perf_fds[kPerfEventCount];
+static bool s_perf_fds_opened = false;
+// Whether the missing counters were reported already; set by the probe in the
+// parent process, so that --isolate children do not repeat it on every load.
+static bool s_perf_reported = false;
 
-    if (res.ok)
+static int open_perf_event(const PerfEventDesc& desc)
+{
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = desc.type;
+    attr.config = desc.config;
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // with perf_event_paranoid >= 2 only user space events can be counted; page
+    // faults are still seen then, context switches are not
+    int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (fd < 0 && (errno == EACCES || errno == EPERM))
     {
-        res.vertex_count = (int)(m.attributes.positions.size() / 3);
-        res.normal_count = (int)(m.attributes.normals.size() / 3);
-        res.uv_count = (int)(m.attributes.texcoords.size() / 2);
-        res.vertex_hash = XXH3_64bits(m.attributes.positions.data(), m.attributes.positions.size() * 4) & 0xFFFFFFFF;
-        res.normal_hash = XXH3_64bits(m.attributes.normals.data(), m.attributes.normals.size() * 4) & 0xFFFFFFFF;
-        res.uv_hash = XXH3_64bits(m.attributes.texcoords.data(), m.attributes.texcoords.size() * 4) & 0xFFFFFFFF;
-        res.shape_count = (int)m.shapes.size();
-        res.material_count = (int)m.materials.size();
+        attr.exclude_kernel = 1;
+        fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
     }
-
-    res.print("rapidobj");
+    return fd;
 }
 
-static void parse_blender(const char* filename)
+static void open_perf_counters()
 {
-    ObjParseStats res;
-    auto t0 = get_time();
-
-    using namespace blender;
-    using namespace blender::io::obj;
-    GlobalVertices verts;
-    Vector<std::unique_ptr<Geometry>> geoms;
-    Map<std::string, std::unique_ptr<MTLMaterial>> mats;
-    OBJImportParams params;
-    strcpy(params.filepath, filename);
-    params.clamp_size = 0;
-    params.forward_axis = OBJ_AXIS_NEGATIVE_Z_FORWARD;
-    params.up_axis = OBJ_AXIS_Y_UP;
-    importer_main(params, verts, geoms, mats);
-
-    res.ok = !verts.vertices.is_empty();
-
-    res.time = get_duration(t0);
-
-    if (res.ok)
+    int opened = 0;
+    for (int i = 0; i < kPerfEventCount; ++i)
     {
-        res.vertex_count = (int)verts.vertices.size();
-        res.normal_count = (int)verts.vertex_normals.size();
-        res.uv_count = (int)verts.uv_vertices.size();
-        res.vertex_hash = XXH3_64bits(verts.vertices.data(), verts.vertices.size() * 12) & 0xFFFFFFFF;
-        res.normal_hash = XXH3_64bits(verts.vertex_normals.data(), verts.vertex_normals.size() * 12) & 0xFFFFFFFF;
-        res.uv_hash = XXH3_64bits(verts.uv_vertices.data(), verts.uv_vertices.size() * 8) & 0xFFFFFFFF;
-        res.shape_count = (int)geoms.size();
-        res.material_count = (int)mats.size();
+        s_perf_fds[i] = open_perf_event(kPerfEvents[i]);
+        opened += s_perf_fds[i] >= 0;
     }
-
-    res.print("blender");
+    s_perf_fds_opened = true;
+    if (opened < kPerfEventCount && !s_perf_reported)
+        fprintf(stderr, "Only %i of %i perf counters are available (not supported, or not allowed by /proc/sys/kernel/perf_event_paranoid)\n", opened, kPerfEventCount);
+    s_perf_reported = true;
 }
+#endif
 
-static void parse_openscenegraph(const char* filename)
+// Checks which perf counters can be opened, and reports the missing ones once.
+// Called in the main process before any load, since with --isolate the counters
+// get opened anew in every load's child process.
+static void probe_perf_counters()
 {
-    ObjParseStats res;
-    auto t0 = get_time();
-
-    using namespace obj;
-    Model m;
-    const char* baseEnd1 = strrchr(filename, '/');
-    const char* baseEnd2 = strrchr(filename, '\\');
-    std::string baseDir = std::string(filename, baseEnd1 > baseEnd2 ? baseEnd1 : baseEnd2);
-    std::ifstream fin(filename);
-    res.ok = m.readOBJ(fin, baseDir);
-
-    res.time = get_duration(t0);
-
-    if (res.ok)
+    #ifdef __linux__
+    if (!s_perf_counters_enabled || s_perf_fds_opened)
+        return;
+    open_perf_counters();
+    for (int& fd : s_perf_fds)
     {
-        res.vertex_count = (int)m.vertices.size();
-        res.normal_count = (int)m.normals.size();
-        res.uv_count = (int)m.texcoords.size();
-        res.vertex_hash = XXH3_64bits(m.vertices.data(), m.vertices.size() * 12) & 0xFFFFFFFF;
-        res.normal_hash = XXH3_64bits(m.normals.data(), m.normals.size() * 12) & 0xFFFFFFFF;
-        res.uv_hash = XXH3_64bits(m.texcoords.data(), m.texcoords.size() * 8) & 0xFFFFFFFF;
-        res.shape_count = (int)m.elementStateMap.size();
-        res.material_count = (int)m.materialMap.size();
+        if (fd >= 0)
+            close(fd);
+        fd = -1;
     }
-
-    res.print("openscenegraph");
+    s_perf_fds_opened = false;
+    #endif
 }
 
-
-static void parse_assimp(const char* filename)
+static void start_perf_counters()
 {
-    ObjParseStats res;
-    auto t0 = get_time();
+    #ifdef __linux__
+    if (!s_perf_counters_enabled)
+        return;
+    if (!s_perf_fds_opened)
+        open_perf_counters();
+    for (int fd : s_perf_fds)
+    {
+        if (fd < 0)
+            continue;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    #endif
+}
 
-    Assimp::Importer imp;
-    const aiScene* scene = imp.ReadFile(filename, 0);
+static void stop_perf_counters(PerfCounts& counts)
+{
+    #ifdef __linux__
+    if (!s_perf_counters_enabled || !s_perf_fds_opened)
+        return;
+    for (int fd : s_perf_fds)
+    {
+        if (fd >= 0)
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    }
+    for (int i = 0; i < kPerfEventCount; ++i)
+    {
+        uint64_t data[3]; // value, time enabled, time running
+        if (s_perf_fds[i] < 0 || read(s_perf_fds[i], data, sizeof(data)) != sizeof(data) || data[2] == 0)
+            continue;
+        // scale up if the counter was multiplexed with others
+        double value = (double)data[0];
+        if (data[2] < data[1])
+            value *= (double)data[1] / data[2];
+        counts.*kPerfEvents[i].value = (int64_t)value;
+    }
+    #else
+    (void)counts;
+    #endif
+}
 
-    res.ok = scene != nullptr;
+// Heap allocation statistics of a load; -1 when not tracked. Needs a build with
+// OBJ_ALLOC_PROFILE, which replaces malloc & co. (with glibc) or the global
+// operator new/delete (elsewhere).
+struct AllocCounts
+{
+    static const int kSizeClasses = 8;
 
-    res.time = get_duration(t0);
+    int64_t count = -1; // allocation calls, including reallocs
+    int64_t bytes = -1; // requested bytes
+    int64_t realloc_copy_bytes = -1; // bytes moved by reallocs that could not resize in place
+    int64_t peak_live_bytes = -1; // peak of allocated minus freed bytes during the load (glibc only)
+    int64_t size_classes[kSizeClasses] = {}; // allocation counts by requested size, see size_class_name()
+    // Blender's own MEM_* allocator statistics (blender parser only)
+    int64_t mem_peak_bytes = -1;
+    int64_t mem_blocks = -1; // blocks allocated during the load and still in use at its end
 
-    if (res.ok)
+    static int size_class(size_t size)
     {
-        // assimp "cooks" the imported data into a rendering-friendly
-        // format where vertices/normals/uvs are no longer separate etc.
-        // So the counting/hashing is not following the other libraries.
-        res.vertex_count = 0;
-        res.normal_count = 0;
-        res.uv_count = 0;
-        for (int i = 0; i < scene->mNumMeshes; ++i)
-        {
-            const aiMesh* m = scene->mMeshes[i];
-            res.vertex_count += m->mNumVertices;
-            res.normal_count += m->mNumVertices;
-            res.uv_count += m->mNumVertices;
-        }
-        res.shape_count = scene->mNumMeshes;
-        res.material_count = scene->mNumMaterials;
+        static const size_t limits[kSizeClasses - 1] = { 16, 64, 256, 1024, 4096, 65536, 1 << 20 };
+        int i = 0;
+        while (i < kSizeClasses - 1 && size > limits[i])
+            ++i;
+        return i;
+    }
+    static const char* size_class_name(int index)
+    {
+        static const char* names[kSizeClasses] = { "16", "64", "256", "1k", "4k", "64k", "1m", "large" };
+        return names[index];
     }
+};
 
-    res.print("assimp");
-}
+static bool s_alloc_tracking_enabled = false;
+
+#ifdef OBJ_ALLOC_PROFILE
+static std::atomic<bool> s_alloc_tracking{false};
+static std::atomic<int64_t> s_alloc_count, s_alloc_bytes, s_alloc_realloc_copy, s_alloc_live, s_alloc_peak;
+static std::atomic<int64_t> s_alloc_size_classes[AllocCounts::kSizeClasses];
 
-static bool readthefile(const char* filename)
+// `usable` is the actual block size, or 0 when not known
+static void track_alloc(size_t size, size_t usable)
 {
-    // just read the file in, to prewarm OS file caches
-    const char* filebuf = read_file(filename);
-    if (filebuf == nullptr)
+    s_alloc_count.fetch_add(1, std::memory_order_relaxed);
+    s_alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+    s_alloc_size_classes[AllocCounts::size_class(size)].fetch_add(1, std::memory_order_relaxed);
+    int64_t live = s_alloc_live.fetch_add(usable, std::memory_order_relaxed) + usable;
+    int64_t peak = s_alloc_peak.load(std::memory_order_relaxed);
+    while (live > peak && !s_alloc_peak.compare_exchange_weak(peak, live, std::memory_order_relaxed))
     {
-        printf("Can't read the file!\n");
-        return false;
     }
-    delete[] filebuf;
-    return true;
 }
 
-int main(int argc, const char* argv[])
+#ifdef __GLIBC__
+// Replace the C allocation functions (used by everything, including the
+// default operator new and Blender's MEM_* allocator) with ones that forward
+// to the glibc implementation.
+extern "C"
+{
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* ptr);
+
+void* malloc(size_t size)
+{
+    void* ptr = __libc_malloc(size);
+    if (ptr && s_alloc_tracking.load(std::memory_order_relaxed))
+        track_alloc(size, malloc_usable_size(ptr));
+    return ptr;
+}
+void* calloc(size_t count, size_t size)
+{
+    void* ptr = __libc_calloc(count, size);
+    if (ptr && s_alloc_tracking.load(std::memory_order_relaxed))
+        track_alloc(count * size, malloc_usable_size(ptr));
+    return ptr;
+}
+void* realloc(void* ptr, size_t size)
 {
-    if (argc < 2)
+    if (!s_alloc_tracking.load(std::memory_order_relaxed))
+        return __libc_realloc(ptr, size);
+    size_t old_usable = ptr ? malloc_usable_size(ptr) : 0;
+    void* res = __libc_realloc(ptr, size);
+    if (res == nullptr)
     {
-        printf("USAGE: obj_parse_tester <obj file>\n");
-        return -1;
+        if (size == 0)
+            s_alloc_live.fetch_sub(old_usable, std::memory_order_relaxed);
+        return res;
+    }
+    s_alloc_live.fetch_sub(old_usable, std::memory_order_relaxed);
+    track_alloc(size, malloc_usable_size(res));
+    if (ptr && res != ptr)
+        s_alloc_realloc_copy.fetch_add(std::min(old_usable, size), std::memory_order_relaxed);
+    return res;
+}
+void* memalign(size_t alignment, size_t size)
+{
+    void* ptr = __libc_memalign(alignment, size);
+    if (ptr && s_alloc_tracking.load(std::memory_order_relaxed))
+        track_alloc(size, malloc_usable_size(ptr));
+    return ptr;
+}
+void* aligned_alloc(size_t alignment, size_t size)
+{
+    return memalign(alignment, size);
+}
+int posix_memalign(void** res, size_t alignment, size_t size)
+{
+    if (alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0)
+        return EINVAL;
+    void* ptr = memalign(alignment, size);
+    if (!ptr)
+        return ENOMEM;
+    *res = ptr;
+    return 0;
+}
+void free(void* ptr)
+{
+    if (ptr && s_alloc_tracking.load(std::memory_order_relaxed))
+        s_alloc_live.fetch_sub(malloc_usable_size(ptr), std::memory_order_relaxed);
+    __libc_free(ptr);
+}
+}
+#else
+// No portable way to replace malloc; count the C++ allocations only.
+void* operator new(size_t size)
+{
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr)
+        throw std::bad_alloc();
+    if (s_alloc_tracking.load(std::memory_order_relaxed))
+        track_alloc(size, 0);
+    return ptr;
+}
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    void* ptr = malloc(size ? size : 1);
+    if (ptr && s_alloc_tracking.load(std::memory_order_relaxed))
+        track_alloc(size, 0);
+    return ptr;
+}
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept
+{
+    return operator new(size, tag);
+}
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+void operator delete[](void* ptr) noexcept
+{
+    free(ptr);
+}
+void operator delete(void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+void operator delete[](void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+#endif
+#endif // #ifdef OBJ_ALLOC_PROFILE
+
+static void start_alloc_tracking()
+{
+    #ifdef OBJ_ALLOC_PROFILE
+    if (!s_alloc_tracking_enabled)
+        return;
+    s_alloc_count = 0;
+    s_alloc_bytes = 0;
+    s_alloc_realloc_copy = 0;
+    s_alloc_live = 0;
+    s_alloc_peak = 0;
+    for (auto& count : s_alloc_size_classes)
+        count = 0;
+    s_alloc_tracking = true;
+    #endif
+}
+
+static void stop_alloc_tracking(AllocCounts& counts)
+{
+    #ifdef OBJ_ALLOC_PROFILE
+    if (!s_alloc_tracking_enabled)
+        return;
+    s_alloc_tracking = false;
+    counts.count = s_alloc_count;
+    counts.bytes = s_alloc_bytes;
+    counts.realloc_copy_bytes = s_alloc_realloc_copy;
+    #ifdef __GLIBC__
+    counts.peak_live_bytes = s_alloc_peak;
+    #endif
+    for (int i = 0; i < AllocCounts::kSizeClasses; ++i)
+        counts.size_classes[i] = s_alloc_size_classes[i];
+    #else
+    (void)counts;
+    #endif
+}
+
+struct ObjParseStats
+{
+    bool ok = false;
+    double time = -1;
+    int vertex_count = -1;
+    int normal_count = -1;
+    int uv_count = -1;
+    int face_count = -1;
+    int shape_count = -1;
+    int material_count = -1;
+    uint32_t vertex_hash = 0;
+    uint32_t normal_hash = 0;
+    uint32_t uv_hash = 0;
+    uint32_t topology_hash = 0; // faces: sizes and corner indices
+    uint32_t material_hash = 0; // faces: topology and material names
+    uint32_t group_hash = 0; // faces: topology and group/object names
+    uint32_t order_hash = 0; // faces in the order they were returned, with their material and group names
+    int64_t peak_memory = -1; // process peak resident memory during the load, bytes
+    int64_t end_memory = -1; // resident memory with the loaded data still alive, bytes
+    // Load time split into phases, for parsers where the boundaries are
+    // observable from the outside; -1 when not known.
+    double time_read = -1; // file I/O
+    double time_parse = -1; // OBJ parsing
+    double time_finalize = -1; // material libraries / post-processing
+    // Time until the first, and half of all the objects/geometries were
+    // complete while the load was still going on; -1 when not observable.
+    double time_first_geometry = -1;
+    double time_half_geometries = -1;
+    // --cook: conversion of the loaded data into render-ready buffers, done
+    // after the load; -1 when not done.
+    double time_cook = -1;
+    double time_destroy = -1; // freeing the loaded data, after the load timer stopped
+    int cooked_vertex_count = -1;
+    int cooked_triangle_count = -1;
+    int cooked_submesh_count = -1;
+    double cache_resident = -1; // fraction of the file in the OS page cache when the load started
+    double cpu_mhz = -1; // frequency of the CPU the load ran on, average of its start and end; -1 when not known
+    double start_cpu_mhz = -1; // CPU frequency read by start_timer, for stop_timer to average into cpu_mhz
+    PerfCounts counters;
+    AllocCounts allocs;
+
+    void print(const char* title) const
+    {
+        char freq[32] = "";
+        if (cpu_mhz > 0)
+            snprintf(freq, sizeof(freq), " cpu=%.0f MHz", cpu_mhz);
+        printf("%-18s ok=%i t=%6.2f s free=%6.3f s v=%8i vn=%8i vt=%8i f=%8i o=%5i mat=%4i hash: v=%08x vn=%08x vt=%08x topo=%08x mat=%08x mem: %5i / %5i MB cached=%3i%%%s\n",
+            title, ok, time, time_destroy, vertex_count, normal_count, uv_count, face_count, shape_count, material_count,
+            vertex_hash, normal_hash, uv_hash, topology_hash, material_hash, to_mb(peak_memory), to_mb(end_memory),
+            cache_resident < 0 ? -1 : (int)(cache_resident * 100 + 0.5), freq);
+    }
+
+    void print_phases() const
+    {
+        printf("%-18s phases: read=%8.4f parse=%8.4f finalize=%8.4f s first geometry=%8.4f 50%% geometries=%8.4f s\n",
+            "", time_read, time_parse, time_finalize, time_first_geometry, time_half_geometries);
+    }
+
+    void print_cooked() const
+    {
+        printf("%-18s cooked: t=%6.3f s load+cook=%6.2f s verts=%8i tris=%8i submeshes=%4i\n",
+            "", time_cook, time_gpu_ready(), cooked_vertex_count, cooked_triangle_count, cooked_submesh_count);
+    }
+
+    // "time to GPU-ready buffers": load plus cook time
+    double time_gpu_ready() const
+    {
+        return time >= 0 && time_cook >= 0 ? time + time_cook : -1;
+    }
+
+    void print_counters() const
+    {
+        const PerfCounts& c = counters;
+        printf("%-18s counters: cycles=%lld instr=%lld ipc=%.2f L1d-miss=%lld LLC-miss=%lld br-miss=%lld faults=%lld ctxsw=%lld\n",
+            "", (long long)c.cycles, (long long)c.instructions, c.ipc(), (long long)c.l1d_misses, (long long)c.llc_misses,
+            (long long)c.branch_misses, (long long)c.page_faults, (long long)c.context_switches);
+    }
+
+    void print_allocs() const
+    {
+        const AllocCounts& a = allocs;
+        printf("%-18s allocs: count=%lld alloc=%.1f MB realloc-copy=%.1f MB peak-live=%.1f MB sizes:",
+            "", (long long)a.count, a.bytes * 1.0e-6, a.realloc_copy_bytes * 1.0e-6, a.peak_live_bytes * 1.0e-6);
+        for (int i = 0; i < AllocCounts::kSizeClasses; ++i)
+            printf(" %s%s:%lld", i < AllocCounts::kSizeClasses - 1 ? "<=" : "", AllocCounts::size_class_name(i), (long long)a.size_classes[i]);
+        if (a.mem_peak_bytes >= 0)
+            printf(" MEM: peak=%.1f MB blocks=%lld", a.mem_peak_bytes * 1.0e-6, (long long)a.mem_blocks);
+        printf("\n");
+    }
+
+    static int to_mb(int64_t bytes)
+    {
+        return bytes < 0 ? -1 : (int)(bytes / (1024 * 1024));
+    }
+};
+
+// Current frequency of the CPU this thread runs on, from cpufreq in /sys;
+// -1 when not available (not Linux, or no cpufreq driver, e.g. in VMs).
+static double read_cpu_mhz()
+{
+    #ifdef __linux__
+    int cpu = sched_getcpu();
+    if (cpu < 0)
+        return -1;
+    char path[128];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%i/cpufreq/scaling_cur_freq", cpu);
+    FILE* f = fopen(path, "r");
+    if (!f)
+        return -1;
+    long long khz = -1;
+    if (fscanf(f, "%lld", &khz) != 1)
+        khz = -1;
+    fclose(f);
+    return khz > 0 ? khz / 1000.0 : -1;
+    #else
+    return -1;
+    #endif
+}
+
+// Starts the load timer (and perf counters) of a parser.
+static std::chrono::steady_clock::time_point start_timer(ObjParseStats& res)
+{
+    res.start_cpu_mhz = read_cpu_mhz();
+    start_alloc_tracking();
+    start_perf_counters();
+    return get_time();
+}
+
+// Stops the load timer of a parser; call while the loaded data is still alive.
+static void stop_timer(ObjParseStats& res, std::chrono::steady_clock::time_point t0)
+{
+    res.time = get_duration(t0);
+    stop_perf_counters(res.counters);
+    stop_alloc_tracking(res.allocs);
+    res.end_memory = get_current_memory();
+    res.peak_memory = get_peak_memory();
+    double end_cpu_mhz = read_cpu_mhz();
+    if (res.start_cpu_mhz > 0 && end_cpu_mhz > 0)
+        res.cpu_mhz = (res.start_cpu_mhz + end_cpu_mhz) / 2;
+    if (res.time_parse < 0 && (res.time_read >= 0 || res.time_finalize >= 0))
+        res.time_parse = res.time - std::max(res.time_read, 0.0) - std::max(res.time_finalize, 0.0);
+}
+
+// Frees the loaded data, timing it into res.time_destroy: the objects are
+// moved into a temporary that gets destroyed right here, instead of when the
+// parse function returns.
+template <typename... T>
+static void destroy_timed(ObjParseStats& res, T&... objects)
+{
+    auto t0 = get_time();
+    {
+        std::tuple<T...> doomed(std::move(objects)...);
+    }
+    res.time_destroy = get_duration(t0);
+}
+
+// Worker thread count for the multithreaded parsers that allow setting it;
+// 0 means the library default.
+static int s_thread_count = 0;
+
+#ifdef __linux__
+static cpu_set_t s_initial_cpu_set;
+static bool s_initial_cpu_set_valid = false;
+#endif
+
+// Restricts the process to the first `count` CPUs it was allowed to run on
+// (0 restores all of them). Parsers that always spawn one worker per hardware
+// thread still do so, their workers just share fewer cores. Only supported
+// on Linux.
+static bool limit_cpu_count(int count)
+{
+    #ifdef __linux__
+    if (!s_initial_cpu_set_valid)
+    {
+        if (sched_getaffinity(0, sizeof(s_initial_cpu_set), &s_initial_cpu_set) != 0)
+            return false;
+        s_initial_cpu_set_valid = true;
+    }
+    cpu_set_t set = s_initial_cpu_set;
+    if (count > 0)
+    {
+        CPU_ZERO(&set);
+        for (int cpu = 0, added = 0; cpu < CPU_SETSIZE && added < count; ++cpu)
+        {
+            if (CPU_ISSET(cpu, &s_initial_cpu_set))
+            {
+                CPU_SET(cpu, &set);
+                ++added;
+            }
+        }
+    }
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+    #else
+    return count == 0;
+    #endif
+}
+
+// Pins the process to one CPU (-1 restores all the CPUs it was allowed to
+// run on), so that single threaded loads do not migrate between cores and
+// their caches. Only supported on Linux.
+static bool pin_to_cpu(int cpu)
+{
+    if (cpu < 0)
+        return limit_cpu_count(0);
+    #ifdef __linux__
+    if (!limit_cpu_count(0))
+        return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+    #else
+    return false;
+    #endif
+}
+
+// Busy loop for the given time, to get the CPU out of its idle states and up
+// to a steady (turbo) frequency before a load gets timed.
+static void spin_cpu(int milliseconds)
+{
+    auto t0 = get_time();
+    volatile uint64_t x = 1;
+    while (get_duration(t0) * 1000 < milliseconds)
+    {
+        for (int i = 0; i < 1000; ++i)
+            x = x * 6364136223846793005ull + 1442695040888963407ull;
+    }
+}
+
+// Summary of the wall-clock times of repeated runs of one parser.
+struct TimingStats
+{
+    // Runs whose 95% confidence interval is wider than this fraction
+    // of the mean are flagged as too noisy to compare.
+    static constexpr double kNoisyThreshold = 0.05;
+
+    int count = 0;
+    double min = -1;
+    double median = -1;
+    double mean = -1;
+    double p95 = -1;
+    double stddev = 0;
+    double ci95 = 0; // half-width of the 95% confidence interval of the mean
+    bool noisy = false;
+
+    // two-sided 95% Student's t critical values, for 1..30 degrees of freedom
+    static double t_critical(int dof)
+    {
+        static const double table[30] = {
+            12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+            2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+            2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+        };
+        if (dof < 1)
+            return 0;
+        return dof <= 30 ? table[dof - 1] : 1.960;
+    }
+
+    static double percentile(const std::vector<double>& sorted, double p)
+    {
+        double pos = p * (sorted.size() - 1);
+        size_t lo = (size_t)pos;
+        size_t hi = std::min(lo + 1, sorted.size() - 1);
+        return sorted[lo] + (sorted[hi] - sorted[lo]) * (pos - lo);
+    }
+
+    void compute(std::vector<double> samples)
+    {
+        count = (int)samples.size();
+        if (count == 0)
+            return;
+        std::sort(samples.begin(), samples.end());
+        min = samples.front();
+        median = percentile(samples, 0.5);
+        p95 = percentile(samples, 0.95);
+        double sum = 0;
+        for (double s : samples)
+            sum += s;
+        mean = sum / count;
+        double var = 0;
+        for (double s : samples)
+            var += (s - mean) * (s - mean);
+        stddev = count > 1 ? sqrt(var / (count - 1)) : 0;
+        ci95 = t_critical(count - 1) * stddev / sqrt((double)count);
+        noisy = count > 1 && mean > 0 && ci95 / mean > kNoisyThreshold;
+    }
+
+    void print() const
+    {
+        printf("%-18s n=%i min=%.4f med=%.4f mean=%.4f p95=%.4f sd=%.4f ci95=%.4f (%.1f%%)%s\n",
+            "", count, min, median, mean, p95, stddev, ci95, mean > 0 ? ci95 / mean * 100 : 0.0,
+            noisy ? " NOISY" : "");
+    }
+};
+
+static char* read_file(const char* filename, size_t* outSize = nullptr)
+{
+    FILE* f = fopen(filename, "rb");
+    if (!f)
+        return nullptr;
+    fseek(f, 0, SEEK_END);
+    #ifdef _MSC_VER
+    auto size = _ftelli64(f);
+    #else
+    auto size = ftello(f);
+    #endif
+    fseek(f, 0, SEEK_SET);
+    char* buf = new char[size];
+    fread(buf, 1, size, f);
+    fclose(f);
+    if (outSize != nullptr)
+        *outSize = size;
+    return buf;
+}
+
+// Ways of reading a whole file into memory, compared with --io-strategies;
+// the --memory buffer can be read with any of them.
+enum class ReadStrategy
+{
+    Fread, // buffered stdio, one fread of the whole file
+    Read, // read() in large blocks into a page aligned buffer
+    Direct, // same with O_DIRECT, bypassing the page cache
+    Fadvise, // same as Read, after posix_fadvise SEQUENTIAL and WILLNEED hints
+    Mmap, // mmap with madvise SEQUENTIAL and WILLNEED hints
+    MmapPopulate, // mmap with MAP_POPULATE
+    Count
+};
+static const char* kReadStrategyNames[] = { "fread", "read", "direct", "fadvise", "mmap", "mmap-populate" };
+static_assert(sizeof(kReadStrategyNames) / sizeof(kReadStrategyNames[0]) == (int)ReadStrategy::Count, "read strategy names");
+
+static const size_t kReadBlockSize = 1 << 20;
+static const size_t kReadAlignment = 4096; // O_DIRECT needs buffer, size and offset aligned
+
+static char* alloc_aligned(size_t size)
+{
+    #ifdef _WIN32
+    return (char*)_aligned_malloc(size, kReadAlignment);
+    #else
+    void* ptr = nullptr;
+    return posix_memalign(&ptr, kReadAlignment, size) == 0 ? (char*)ptr : nullptr;
+    #endif
+}
+static void free_aligned(char* ptr)
+{
+    #ifdef _WIN32
+    _aligned_free(ptr);
+    #else
+    free(ptr);
+    #endif
+}
+
+// File contents read with one of the strategies; owns the buffer or mapping.
+struct FileData
+{
+    char* data = nullptr;
+    size_t size = 0;
+    bool mapped = false;
+
+    FileData() = default;
+    FileData(const FileData&) = delete;
+    FileData& operator=(const FileData&) = delete;
+    ~FileData() { release(); }
+
+    void release()
+    {
+        #ifndef _WIN32
+        if (mapped)
+            munmap(data, size);
+        else
+        #endif
+            free_aligned(data);
+        data = nullptr;
+        size = 0;
+        mapped = false;
+    }
+};
+
+#ifndef _WIN32
+static bool read_blocks(int fd, char* buf, size_t size, size_t capacity)
+{
+    size_t pos = 0;
+    while (pos < size)
+    {
+        ssize_t got = read(fd, buf + pos, std::min(kReadBlockSize, capacity - pos));
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got <= 0)
+            return false;
+        pos += (size_t)got;
+    }
+    return true;
+}
+#endif
+
+// Returns false if reading failed, or the strategy is not supported on this
+// platform or file system (e.g. O_DIRECT on tmpfs).
+static bool read_file_with(ReadStrategy strategy, const char* filename, FileData& out)
+{
+    out.release();
+    if (strategy == ReadStrategy::Fread)
+    {
+        FILE* f = fopen(filename, "rb");
+        if (!f)
+            return false;
+        fseek(f, 0, SEEK_END);
+        #ifdef _MSC_VER
+        auto size = _ftelli64(f);
+        #else
+        auto size = ftello(f);
+        #endif
+        fseek(f, 0, SEEK_SET);
+        out.data = alloc_aligned(size > 0 ? (size_t)size : 1);
+        out.size = (size_t)size;
+        bool ok = out.data != nullptr && fread(out.data, 1, out.size, f) == out.size;
+        fclose(f);
+        if (!ok)
+            out.release();
+        return ok;
+    }
+
+    #ifdef _WIN32
+    return false;
+    #else
+    int flags = O_RDONLY;
+    if (strategy == ReadStrategy::Direct)
+    {
+        #ifdef O_DIRECT
+        flags |= O_DIRECT;
+        #else
+        return false;
+        #endif
+    }
+    int fd = open(filename, flags);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return false;
+    }
+    size_t size = (size_t)st.st_size;
+    bool ok = false;
+    if (strategy == ReadStrategy::Mmap || strategy == ReadStrategy::MmapPopulate)
+    {
+        int map_flags = MAP_PRIVATE;
+        #ifdef MAP_POPULATE
+        if (strategy == ReadStrategy::MmapPopulate)
+            map_flags |= MAP_POPULATE;
+        #else
+        if (strategy == ReadStrategy::MmapPopulate)
+            size = 0;
+        #endif
+        void* map = size > 0 ? mmap(nullptr, size, PROT_READ, map_flags, fd, 0) : MAP_FAILED;
+        if (map != MAP_FAILED)
+        {
+            if (strategy == ReadStrategy::Mmap)
+            {
+                madvise(map, size, MADV_SEQUENTIAL);
+                madvise(map, size, MADV_WILLNEED);
+            }
+            out.data = (char*)map;
+            out.size = size;
+            out.mapped = true;
+            ok = true;
+        }
+    }
+    else
+    {
+        bool supported = true;
+        if (strategy == ReadStrategy::Fadvise)
+        {
+            #ifdef POSIX_FADV_SEQUENTIAL
+            posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+            posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+            #else
+            supported = false;
+            #endif
+        }
+        size_t capacity = (size + kReadAlignment - 1) / kReadAlignment * kReadAlignment;
+        char* buf = supported ? alloc_aligned(capacity > 0 ? capacity : kReadAlignment) : nullptr;
+        if (buf != nullptr && read_blocks(fd, buf, size, capacity))
+        {
+            out.data = buf;
+            out.size = size;
+            ok = true;
+        }
+        else
+            free_aligned(buf);
+    }
+    close(fd);
+    return ok;
+    #endif
+}
+
+// Seconds to get the whole file into memory with the strategy, evicting it
+// from the page cache first if cold; -1 if not supported.
+static double time_read_strategy(ReadStrategy strategy, const char* filename, bool cold)
+{
+    if (cold && !evict_file_cache(filename))
+        return -1;
+    auto t0 = get_time();
+    FileData file;
+    if (!read_file_with(strategy, filename, file))
+        return -1;
+    // mappings are read lazily (unless populated), so touch every page to
+    // have all the data in memory, like the other strategies do
+    unsigned sum = 0;
+    for (size_t i = 0; i < file.size; i += kReadAlignment)
+        sum += (unsigned char)file.data[i];
+    double duration = get_duration(t0);
+    return sum == ~0u ? -1 : duration;
+}
+
+// Median read throughput of each strategy on a file, warm and cold cache.
+struct ReadStrategyResults
+{
+    double warm_mbs[(int)ReadStrategy::Count] = {};
+    double cold_mbs[(int)ReadStrategy::Count] = {};
+
+    static double measure(ReadStrategy strategy, const char* filename, int64_t size, bool cold, int iterations)
+    {
+        std::vector<double> times;
+        for (int i = 0; i < iterations; ++i)
+        {
+            double t = time_read_strategy(strategy, filename, cold);
+            if (t <= 0)
+                return -1;
+            times.push_back(t);
+        }
+        std::sort(times.begin(), times.end());
+        return size * 1.0e-6 / times[times.size() / 2];
+    }
+
+    void run(const char* filename, int64_t size, int iterations)
+    {
+        // cold first, so the warm runs leave the file cached for the parsers
+        for (int i = 0; i < (int)ReadStrategy::Count; ++i)
+            cold_mbs[i] = measure((ReadStrategy)i, filename, size, true, iterations);
+        for (int i = 0; i < (int)ReadStrategy::Count; ++i)
+            warm_mbs[i] = measure((ReadStrategy)i, filename, size, false, iterations);
+    }
+
+    // Fastest strategy, or ReadStrategy::Count when none of them worked.
+    static ReadStrategy best(const double* mbs)
+    {
+        int best = 0;
+        for (int i = 1; i < (int)ReadStrategy::Count; ++i)
+        {
+            if (mbs[i] > mbs[best])
+                best = i;
+        }
+        return mbs[best] > 0 ? (ReadStrategy)best : ReadStrategy::Count;
+    }
+
+    static const char* best_name(const double* mbs)
+    {
+        ReadStrategy strategy = best(mbs);
+        return strategy != ReadStrategy::Count ? kReadStrategyNames[(int)strategy] : "n/a";
+    }
+
+    void print() const
+    {
+        printf("%-18s %10s %10s\n", "read strategy", "warm MB/s", "cold MB/s");
+        for (int i = 0; i < (int)ReadStrategy::Count; ++i)
+        {
+            char warm[32] = "n/a", cold[32] = "n/a";
+            if (warm_mbs[i] > 0)
+                snprintf(warm, sizeof(warm), "%.1f", warm_mbs[i]);
+            if (cold_mbs[i] > 0)
+                snprintf(cold, sizeof(cold), "%.1f", cold_mbs[i]);
+            printf("%-18s %10s %10s\n", kReadStrategyNames[i], warm, cold);
+        }
+        printf("%-18s warm: %s cold: %s\n", "best", best_name(warm_mbs), best_name(cold_mbs));
+    }
+};
+
+// Number of '\n' bytes, 16 at a time with SSE2 where available.
+static size_t count_newlines(const char* data, size_t size)
+{
+    size_t count = 0, i = 0;
+    #if defined(__SSE2__) || defined(_M_X64)
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (; i + 16 <= size; i += 16)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(data + i));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline));
+        while (mask)
+        {
+            mask &= mask - 1;
+            ++count;
+        }
+    }
+    #endif
+    for (; i < size; ++i)
+        count += data[i] == '\n';
+    return count;
+}
+
+// Number of whitespace separated tokens, one byte at a time: about the least
+// work any OBJ parser has to do on every byte.
+static size_t count_tokens(const char* data, size_t size)
+{
+    size_t count = 0;
+    bool in_token = false;
+    for (size_t i = 0; i < size; ++i)
+    {
+        bool space = (unsigned char)data[i] <= ' ';
+        count += !space && !in_token;
+        in_token = !space;
+    }
+    return count;
+}
+
+// Throughput of reference kernels on the file contents, for --speed-of-light:
+// how fast a parser could possibly go when limited by reading the file,
+// memory bandwidth, or the simplest possible scan of it.
+struct SpeedOfLight
+{
+    enum Kernel
+    {
+        ReadFile,
+        Memcpy,
+        NewlineCount,
+        Tokenize,
+        KernelCount
+    };
+    static constexpr const char* kNames[KernelCount] = { "read_file", "memcpy", "newline count", "tokenizer" };
+    double mbs[KernelCount] = { -1, -1, -1, -1 };
+    static inline volatile size_t s_sink = 0; // kernel results, so that they do not get optimized away
+
+    void run(const char* filename, int iterations)
+    {
+        std::vector<double> times[KernelCount];
+        size_t size = 0, sink = 0;
+        for (int i = 0; i < iterations; ++i)
+        {
+            auto t0 = get_time();
+            std::unique_ptr<char[]> data(read_file(filename, &size));
+            times[ReadFile].push_back(get_duration(t0));
+            if (!data)
+                return;
+            std::unique_ptr<char[]> copy(new char[size]);
+            memset(copy.get(), 0, size); // not timing the page faults
+            t0 = get_time();
+            memcpy(copy.get(), data.get(), size);
+            times[Memcpy].push_back(get_duration(t0));
+            sink += copy[size / 2];
+            t0 = get_time();
+            sink += count_newlines(data.get(), size);
+            times[NewlineCount].push_back(get_duration(t0));
+            t0 = get_time();
+            sink += count_tokens(data.get(), size);
+            times[Tokenize].push_back(get_duration(t0));
+        }
+        for (int k = 0; k < KernelCount; ++k)
+        {
+            std::sort(times[k].begin(), times[k].end());
+            double t = TimingStats::percentile(times[k], 0.5);
+            mbs[k] = t > 0 ? size * 1.0e-6 / t : -1;
+        }
+        s_sink = sink;
+    }
+
+    void print() const
+    {
+        printf("%-18s", "speed of light");
+        for (int k = 0; k < KernelCount; ++k)
+            printf(" %s=%.1f MB/s", kNames[k], mbs[k]);
+        printf("\n");
+    }
+
+    // The parser's throughput as a fraction of each kernel's.
+    void print_fractions(const char* parser, double parser_mbs) const
+    {
+        printf("%-18s %9.1f MB/s =", parser, parser_mbs);
+        for (int k = 0; k < KernelCount; ++k)
+        {
+            if (mbs[k] > 0)
+                printf(" %6.2f%% of %s", parser_mbs / mbs[k] * 100, kNames[k]);
+        }
+        printf("\n");
+    }
+};
+
+// With --memory, the contents of the file being tested, loaded once before
+// the parsers run; they parse from this instead of reading the file.
+struct InputBuffer
+{
+    const char* filename = nullptr;
+    const char* data = nullptr;
+    size_t size = 0;
+
+    bool is(const char* path) const { return data != nullptr && strcmp(path, filename) == 0; }
+};
+static InputBuffer s_memory_input;
+
+// Read-only std::istream buffer over memory, without copying it.
+struct MemoryStreamBuf : std::streambuf
+{
+    MemoryStreamBuf(const char* data, size_t size)
+    {
+        char* ptr = const_cast<char*>(data);
+        setg(ptr, ptr, ptr + size);
+    }
+};
+
+
+// Faces of the loaded data, in a representation common to all the parsers.
+//
+// The visit_faces functions below call sink.face(corners, count, material, group)
+// for every polygon face. Corner indices are zero-based into the position/uv/normal
+// lists of the whole file, -1 when not present. The group is the face's `g` name,
+// or the `o` name when the parser does not track groups separately. The order
+// of the faces is the parser's own (OSG for example sorts them by state).
+struct FaceCorner
+{
+    int v, vt, vn;
+};
+
+template <typename Sink>
+static void visit_faces(const tinyobj::attrib_t& attrib, const std::vector<tinyobj::shape_t>& shapes,
+    const std::vector<tinyobj::material_t>& materials, Sink& sink)
+{
+    std::vector<FaceCorner> corners;
+    for (const tinyobj::shape_t& sh : shapes)
+    {
+        size_t offset = 0;
+        for (size_t f = 0; f < sh.mesh.num_face_vertices.size(); ++f)
+        {
+            int count = sh.mesh.num_face_vertices[f];
+            corners.resize(count);
+            for (int k = 0; k < count; ++k)
+            {
+                const tinyobj::index_t& idx = sh.mesh.indices[offset + k];
+                corners[k] = { idx.vertex_index, idx.texcoord_index, idx.normal_index };
+            }
+            offset += count;
+            int mat = f < sh.mesh.material_ids.size() ? sh.mesh.material_ids[f] : -1;
+            sink.face(corners.data(), count, mat >= 0 && mat < (int)materials.size() ? materials[mat].name.c_str() : "", sh.name.c_str());
+        }
+    }
+}
+
+template <typename Sink>
+static void visit_faces(const tinyobj_opt::attrib_t& attrib, const std::vector<tinyobj_opt::shape_t>& shapes,
+    const std::vector<tinyobj_opt::material_t>& materials, Sink& sink)
+{
+    // note: assumes resolved zero-based indices, negative when not present
+    std::vector<FaceCorner> corners;
+    std::vector<size_t> face_offsets(attrib.face_num_verts.size());
+    for (size_t f = 0, offset = 0; f < face_offsets.size(); ++f)
+    {
+        face_offsets[f] = offset;
+        offset += attrib.face_num_verts[f];
+    }
+    for (const tinyobj_opt::shape_t& sh : shapes)
+    {
+        for (size_t f = sh.face_offset; f < sh.face_offset + sh.length && f < face_offsets.size(); ++f)
+        {
+            int count = attrib.face_num_verts[f];
+            corners.resize(count);
+            for (int k = 0; k < count; ++k)
+            {
+                const tinyobj_opt::index_t& idx = attrib.indices[face_offsets[f] + k];
+                corners[k] = { idx.vertex_index, idx.texcoord_index < 0 ? -1 : idx.texcoord_index, idx.normal_index < 0 ? -1 : idx.normal_index };
+            }
+            int mat = f < attrib.material_ids.size() ? attrib.material_ids[f] : -1;
+            sink.face(corners.data(), count, mat >= 0 && mat < (int)materials.size() ? materials[mat].name.c_str() : "", sh.name.c_str());
+        }
+    }
+}
+
+template <typename Sink>
+static void visit_faces(const fastObjMesh* m, Sink& sink)
+{
+    std::vector<FaceCorner> corners;
+    for (unsigned int g = 0; g < m->group_count; ++g)
+    {
+        const fastObjGroup& grp = m->groups[g];
+        size_t offset = grp.index_offset;
+        for (unsigned int f = grp.face_offset; f < grp.face_offset + grp.face_count; ++f)
+        {
+            int count = m->face_vertices[f];
+            corners.resize(count);
+            for (int k = 0; k < count; ++k)
+            {
+                // fast_obj indices are one-based, with 0 meaning not present
+                const fastObjIndex& idx = m->indices[offset + k];
+                corners[k] = { (int)idx.p - 1, (int)idx.t - 1, (int)idx.n - 1 };
+            }
+            offset += count;
+            unsigned int mat = m->face_materials[f];
+            const char* mat_name = mat < m->material_count && m->materials[mat].name ? m->materials[mat].name : "";
+            sink.face(corners.data(), count, mat_name, grp.name ? grp.name : "");
+        }
+    }
+}
+
+template <typename Sink>
+static void visit_faces(const rapidobj::Result& m, Sink& sink)
+{
+    std::vector<FaceCorner> corners;
+    for (const rapidobj::Shape& sh : m.shapes)
+    {
+        size_t offset = 0;
+        for (size_t f = 0; f < sh.mesh.num_face_vertices.size(); ++f)
+        {
+            int count = sh.mesh.num_face_vertices[f];
+            corners.resize(count);
+            for (int k = 0; k < count; ++k)
+            {
+                const rapidobj::Index& idx = sh.mesh.indices[offset + k];
+                corners[k] = { idx.position_index, idx.texcoord_index, idx.normal_index };
+            }
+            offset += count;
+            int mat = f < sh.mesh.material_ids.size() ? sh.mesh.material_ids[f] : -1;
+            sink.face(corners.data(), count, mat >= 0 && mat < (int)m.materials.size() ? m.materials[mat].name.c_str() : "", sh.name.c_str());
+        }
+    }
+}
+
+template <typename Sink>
+static void visit_faces(const blender::Vector<std::unique_ptr<blender::io::obj::Geometry>>& geoms, Sink& sink)
+{
+    using namespace blender::io::obj;
+    std::vector<FaceCorner> corners;
+    for (const auto& geom : geoms)
+    {
+        for (const PolyElem& face : geom->face_elements_)
+        {
+            corners.resize(face.corner_count_);
+            for (int k = 0; k < face.corner_count_; ++k)
+            {
+                // vertex indices are stored relative to the geometry start; normal
+                // indices are only resolved when the geometry has normals
+                const PolyCorner& c = geom->face_corners_[face.start_index_ + k];
+                corners[k] = { c.vert_index + geom->vertex_start_, c.uv_vert_index < 0 ? -1 : c.uv_vert_index,
+                    geom->has_vertex_normals_ && c.vertex_normal_index >= 0 ? c.vertex_normal_index : -1 };
+            }
+            // material/group state carries over `o` lines, so the indices can be out of range of the geometry
+            const char* mat = face.material_index >= 0 && face.material_index < geom->material_order_.size() ?
+                geom->material_order_[face.material_index].c_str() : "";
+            const char* group = face.vertex_group_index >= 0 && face.vertex_group_index < geom->group_order_.size() ?
+                geom->group_order_[face.vertex_group_index].c_str() : "";
+            sink.face(corners.data(), face.corner_count_, mat, group[0] ? group : geom->geometry_name_.c_str());
+        }
+    }
+}
+
+template <typename Sink>
+static void visit_faces(const obj::Model& m, Sink& sink)
+{
+    using namespace obj;
+    std::vector<FaceCorner> corners;
+    for (const auto& it : m.elementStateMap)
+    {
+        const ElementState& state = it.first;
+        const char* group = state.groupName.empty() ? state.objectName.c_str() : state.groupName.c_str();
+        for (const auto& el : it.second)
+        {
+            if (el->dataType != Element::POLYGON)
+                continue;
+            int count = (int)el->vertexIndices.size();
+            bool has_uv = el->texCoordIndices.size() == el->vertexIndices.size();
+            bool has_normal = el->normalIndices.size() == el->vertexIndices.size();
+            corners.resize(count);
+            for (int k = 0; k < count; ++k)
+                corners[k] = { el->vertexIndices[k], has_uv ? el->texCoordIndices[k] : -1, has_normal ? el->normalIndices[k] : -1 };
+            sink.face(corners.data(), count, state.materialName.c_str(), group);
+        }
+    }
+}
+
+// Order-independent hashes of all the faces, so that parsers that produce
+// the same faces in a different order still match.
+struct FaceHasher
+{
+    uint64_t topology = 0;
+    uint64_t materials = 0;
+    uint64_t groups = 0;
+    uint64_t order = 0;
+    std::vector<int> buffer;
+
+    void face(const FaceCorner* corners, int count, const char* material, const char* group)
+    {
+        buffer.resize(1 + count * 3);
+        buffer[0] = count;
+        memcpy(buffer.data() + 1, corners, count * sizeof(FaceCorner));
+        uint64_t h = XXH3_64bits(buffer.data(), buffer.size() * sizeof(int));
+        topology += h;
+        uint64_t hm = h ^ XXH3_64bits(material, strlen(material)) * 0x9E3779B97F4A7C15ull;
+        uint64_t hg = h ^ XXH3_64bits(group, strlen(group)) * 0xC2B2AE3D27D4EB4Full;
+        materials += hm;
+        groups += hg;
+        // the others are sums, so that face order does not matter; this one
+        // changes whenever the faces or shapes come out in a different order
+        order = (order ^ hm ^ (hg << 1)) * 0x100000001B3ull + 0x9E3779B97F4A7C15ull;
+    }
+
+    void store(ObjParseStats& res) const
+    {
+        res.topology_hash = topology & 0xFFFFFFFF;
+        res.material_hash = materials & 0xFFFFFFFF;
+        res.group_hash = groups & 0xFFFFFFFF;
+        res.order_hash = (order ^ (order >> 32)) & 0xFFFFFFFF;
+    }
+};
+
+static_assert(sizeof(FaceCorner) == 3 * sizeof(int), "FaceCorner gets hashed as an array of ints");
+
+static bool s_cook_enabled = false;
+
+// Converts loaded data into what a renderer would upload, the same way for
+// all the parsers: one vertex buffer with position, normal and uv of each
+// unique face corner, and a triangulated (fan) index buffer split into one
+// range per material. Timing starts on construction and ends in store().
+struct MeshCooker
+{
+    static const int kVertexFloats = 8;
+
+    struct Submesh
+    {
+        std::string material;
+        std::vector<uint32_t> indices;
+        uint32_t index_start = 0;
+    };
+    struct CornerHash
+    {
+        size_t operator()(const FaceCorner& c) const
+        {
+            return ((uint64_t)(uint32_t)c.v * 0x9E3779B97F4A7C15ull) ^ ((uint64_t)(uint32_t)c.vt * 0xC2B2AE3D27D4EB4Full) ^ (uint32_t)c.vn;
+        }
+    };
+    struct CornerEqual
+    {
+        bool operator()(const FaceCorner& a, const FaceCorner& b) const
+        {
+            return a.v == b.v && a.vt == b.vt && a.vn == b.vn;
+        }
+    };
+
+    std::chrono::steady_clock::time_point t0 = get_time();
+    const float* positions;
+    int position_count;
+    const float* normals;
+    int normal_count;
+    const float* uvs;
+    int uv_count;
+    std::vector<float> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<Submesh> submeshes;
+    Submesh* last_submesh = nullptr;
+    std::unordered_map<FaceCorner, uint32_t, CornerHash, CornerEqual> vertex_map;
+
+    MeshCooker(const float* positions, int position_count, const float* normals, int normal_count, const float* uvs, int uv_count)
+        : positions(positions), position_count(position_count), normals(normals), normal_count(normal_count), uvs(uvs), uv_count(uv_count)
+    {
+    }
+
+    uint32_t append_vertex(const float* pos, const float* normal, const float* uv)
+    {
+        static const float zero[3] = {};
+        pos = pos ? pos : zero;
+        normal = normal ? normal : zero;
+        uv = uv ? uv : zero;
+        const float v[kVertexFloats] = { pos[0], pos[1], pos[2], normal[0], normal[1], normal[2], uv[0], uv[1] };
+        vertices.insert(vertices.end(), v, v + kVertexFloats);
+        return (uint32_t)(vertices.size() / kVertexFloats - 1);
+    }
+
+    uint32_t vertex_index(const FaceCorner& c)
+    {
+        auto it = vertex_map.find(c);
+        if (it != vertex_map.end())
+            return it->second;
+        // out of range indices (broken files, parser quirks) get zeroes
+        uint32_t index = append_vertex(
+            c.v >= 0 && c.v < position_count ? positions + c.v * 3 : nullptr,
+            c.vn >= 0 && c.vn < normal_count ? normals + c.vn * 3 : nullptr,
+            c.vt >= 0 && c.vt < uv_count ? uvs + c.vt * 2 : nullptr);
+        vertex_map.emplace(c, index);
+        return index;
+    }
+
+    std::vector<uint32_t>& submesh(const char* material)
+    {
+        if (last_submesh == nullptr || last_submesh->material != material)
+        {
+            last_submesh = nullptr;
+            for (Submesh& sm : submeshes)
+            {
+                if (sm.material == material)
+                    last_submesh = &sm;
+            }
+            if (last_submesh == nullptr)
+            {
+                submeshes.emplace_back();
+                submeshes.back().material = material;
+                // pointers to the elements get invalidated on growth
+                last_submesh = &submeshes.back();
+            }
+        }
+        return last_submesh->indices;
+    }
+
+    void face(const FaceCorner* corners, int count, const char* material, const char* group)
+    {
+        if (count < 3)
+            return;
+        std::vector<uint32_t>& dst = submesh(material);
+        uint32_t first = vertex_index(corners[0]);
+        uint32_t prev = vertex_index(corners[1]);
+        for (int k = 2; k < count; ++k)
+        {
+            uint32_t cur = vertex_index(corners[k]);
+            dst.insert(dst.end(), { first, prev, cur });
+            prev = cur;
+        }
+    }
+
+    void store(ObjParseStats& res)
+    {
+        for (Submesh& sm : submeshes)
+        {
+            sm.index_start = (uint32_t)indices.size();
+            indices.insert(indices.end(), sm.indices.begin(), sm.indices.end());
+        }
+        res.time_cook = get_duration(t0);
+        res.cooked_vertex_count = (int)(vertices.size() / kVertexFloats);
+        res.cooked_triangle_count = (int)(indices.size() / 3);
+        res.cooked_submesh_count = (int)submeshes.size();
+    }
+};
+
+static ObjParseStats parse_tinyobjloader(const char* filename)
+{
+    ObjParseStats res;
+    auto t0 = start_timer(res);
+
+    using namespace tinyobj;
+    attrib_t attrib;
+    std::vector<shape_t> shapes;
+    std::vector<material_t> materials;
+    std::string err;
+    std::string warn;
+    const char* baseEnd1 = strrchr(filename, '/');
+    const char* baseEnd2 = strrchr(filename, '\\');
+    std::string baseDir = std::string(filename, baseEnd1 > baseEnd2 ? baseEnd1 : baseEnd2);
+    if (s_memory_input.is(filename))
+    {
+        MemoryStreamBuf buf(s_memory_input.data, s_memory_input.size);
+        std::istream in(&buf);
+        MaterialFileReader mtl_reader(baseDir.empty() ? baseDir : baseDir + "/");
+        res.ok = LoadObj(&attrib, &shapes, &materials, &warn, &err, &in, &mtl_reader, false, false);
+    }
+    else
+        res.ok = LoadObj(&attrib, &shapes, &materials, &warn, &err, filename, baseDir.c_str(), false, false);
+
+    stop_timer(res, t0);
+
+    if (res.ok)
+    {
+        res.vertex_count = (int)(attrib.vertices.size() / 3);
+        res.normal_count = (int)(attrib.normals.size() / 3);
+        res.uv_count = (int)(attrib.texcoords.size() / 2);
+        res.vertex_hash = XXH3_64bits(attrib.vertices.data(), attrib.vertices.size() * 4) & 0xFFFFFFFF;
+        res.normal_hash = XXH3_64bits(attrib.normals.data(), attrib.normals.size() * 4) & 0xFFFFFFFF;
+        res.uv_hash = XXH3_64bits(attrib.texcoords.data(), attrib.texcoords.size() * 4) & 0xFFFFFFFF;
+        res.face_count = 0;
+        for (const shape_t& sh : shapes)
+            res.face_count += (int)sh.mesh.num_face_vertices.size();
+        res.shape_count = (int)shapes.size();
+        res.material_count = (int)materials.size();
+        FaceHasher hasher;
+        visit_faces(attrib, shapes, materials, hasher);
+        hasher.store(res);
+        if (s_cook_enabled)
+        {
+            MeshCooker cooker(attrib.vertices.data(), res.vertex_count, attrib.normals.data(), res.normal_count,
+                attrib.texcoords.data(), res.uv_count);
+            visit_faces(attrib, shapes, materials, cooker);
+            cooker.store(res);
+        }
+    }
+    destroy_timed(res, attrib, shapes, materials);
+
+    return res;
+}
+
+static ObjParseStats parse_tinyobjloader_opt(const char* filename)
+{
+    ObjParseStats res;
+    auto t0 = start_timer(res);
+
+    using namespace tinyobj_opt;
+    attrib_t attrib;
+    std::vector<shape_t> shapes;
+    std::vector<material_t> materials;
+    size_t filesize = 0;
+    char* filebuf = nullptr;
+    if (s_memory_input.is(filename))
+        filesize = s_memory_input.size;
+    else
+        filebuf = read_file(filename, &filesize);
+    res.time_read = get_duration(t0);
+    LoadOption options;
+    options.triangulate = false;
+    if (s_thread_count > 0)
+        options.req_num_threads = s_thread_count;
+    res.ok = parseObj(&attrib, &shapes, &materials, filebuf ? filebuf : s_memory_input.data, filesize, options);
+    delete[] filebuf;
+
+    stop_timer(res, t0);
+
+    if (res.ok)
+    {
+        res.vertex_count = (int)(attrib.vertices.size() / 3);
+        res.normal_count = (int)(attrib.normals.size() / 3);
+        res.uv_count = (int)(attrib.texcoords.size() / 2);
+        res.vertex_hash = XXH3_64bits(attrib.vertices.data(), attrib.vertices.size() * 4) & 0xFFFFFFFF;
+        res.normal_hash = XXH3_64bits(attrib.normals.data(), attrib.normals.size() * 4) & 0xFFFFFFFF;
+        res.uv_hash = XXH3_64bits(attrib.texcoords.data(), attrib.texcoords.size() * 4) & 0xFFFFFFFF;
+        res.face_count = (int)attrib.face_num_verts.size();
+        res.shape_count = (int)shapes.size();
+        res.material_count = (int)materials.size();
+        FaceHasher hasher;
+        visit_faces(attrib, shapes, materials, hasher);
+        hasher.store(res);
+        if (s_cook_enabled)
+        {
+            MeshCooker cooker(attrib.vertices.data(), res.vertex_count, attrib.normals.data(), res.normal_count,
+                attrib.texcoords.data(), res.uv_count);
+            visit_faces(attrib, shapes, materials, cooker);
+            cooker.store(res);
+        }
+    }
+    destroy_timed(res, attrib, shapes, materials);
+
+    return res;
+}
+
+// fast_obj file callbacks that do the same as the built-in ones, but also
+// accumulate the time spent reading into a double pointed to by user_data,
+// and serve the --memory input buffer instead of reading that file.
+struct FastObjFile
+{
+    FILE* file = nullptr;
+    const char* data = nullptr;
+    size_t size = 0;
+    size_t pos = 0;
+};
+static void* fast_obj_timed_open(const char* path, void* user_data)
+{
+    FastObjFile* f = new FastObjFile();
+    if (s_memory_input.is(path))
+    {
+        f->data = s_memory_input.data;
+        f->size = s_memory_input.size;
+    }
+    else if ((f->file = fopen(path, "rb")) == nullptr)
+    {
+        delete f;
+        return nullptr;
+    }
+    return f;
+}
+static void fast_obj_timed_close(void* file, void* user_data)
+{
+    FastObjFile* f = (FastObjFile*)file;
+    if (f->file)
+        fclose(f->file);
+    delete f;
+}
+static size_t fast_obj_timed_read(void* file, void* dst, size_t bytes, void* user_data)
+{
+    FastObjFile* f = (FastObjFile*)file;
+    auto t0 = get_time();
+    size_t res;
+    if (f->file)
+        res = fread(dst, 1, bytes, f->file);
+    else
+    {
+        res = std::min(bytes, f->size - f->pos);
+        memcpy(dst, f->data + f->pos, res);
+        f->pos += res;
+    }
+    *(double*)user_data += get_duration(t0);
+    return res;
+}
+static unsigned long fast_obj_timed_size(void* file, void* user_data)
+{
+    FastObjFile* f = (FastObjFile*)file;
+    if (!f->file)
+        return (unsigned long)f->size;
+    long pos = ftell(f->file);
+    fseek(f->file, 0, SEEK_END);
+    long size = ftell(f->file);
+    fseek(f->file, pos, SEEK_SET);
+    return size < 0 ? 0 : (unsigned long)size;
+}
+
+static ObjParseStats parse_fast_obj(const char* filename)
+{
+    ObjParseStats res;
+    auto t0 = start_timer(res);
+
+    fastObjCallbacks callbacks;
+    callbacks.file_open = fast_obj_timed_open;
+    callbacks.file_close = fast_obj_timed_close;
+    callbacks.file_read = fast_obj_timed_read;
+    callbacks.file_size = fast_obj_timed_size;
+    double read_time = 0;
+    fastObjMesh* m = fast_obj_read_with_callbacks(filename, &callbacks, &read_time);
+    res.time_read = read_time;
+    res.ok = m != nullptr;
+
+    stop_timer(res, t0);
+
+    if (res.ok)
+    {
+        res.vertex_count = m->position_count - 1;
+        res.normal_count = m->normal_count - 1;
+        res.uv_count = m->texcoord_count - 1;
+        res.vertex_hash = XXH3_64bits(m->positions + 3, (m->position_count-1) * 12) & 0xFFFFFFFF;
+        res.normal_hash = XXH3_64bits(m->normals + 3, (m->normal_count-1) * 12) & 0xFFFFFFFF;
+        res.uv_hash = XXH3_64bits(m->texcoords + 2, (m->texcoord_count-1) * 8) & 0xFFFFFFFF;
+        res.face_count = m->face_count;
+        res.shape_count = m->group_count;
+        res.material_count = m->material_count;
+        FaceHasher hasher;
+        visit_faces(m, hasher);
+        hasher.store(res);
+        if (s_cook_enabled)
+        {
+            MeshCooker cooker(m->positions + 3, res.vertex_count, m->normals + 3, res.normal_count, m->texcoords + 2, res.uv_count);
+            visit_faces(m, cooker);
+            cooker.store(res);
+        }
+    }
+    if (m != nullptr)
+    {
+        auto t_destroy = get_time();
+        fast_obj_destroy(m);
+        res.time_destroy = get_duration(t_destroy);
+    }
+
+    return res;
+}
+
+static ObjParseStats parse_rapidobj(const char* filename)
+{
+    ObjParseStats res;
+    auto t0 = start_timer(res);
+
+    // note: rapidobj always uses one worker per hardware thread; the thread
+    // sweep limits it via CPU affinity instead
+    rapidobj::Result m;
+    if (s_memory_input.is(filename))
+    {
+        MemoryStreamBuf buf(s_memory_input.data, s_memory_input.size);
+        std::istream in(&buf);
+        std::filesystem::path dir = std::filesystem::path(filename).parent_path();
+        m = rapidobj::ParseStream(in, rapidobj::MaterialLibrary::SearchPath(dir.empty() ? "." : dir, rapidobj::Load::Optional));
+    }
+    else
+        m = rapidobj::ParseFile(filename);
+    res.ok = !m.error;
+
+    stop_timer(res, t0);
+
+    if (res.ok)
+    {
+        res.vertex_count = (int)(m.attributes.positions.size() / 3);
+        res.normal_count = (int)(m.attributes.normals.size() / 3);
+        res.uv_count = (int)(m.attributes.texcoords.size() / 2);
+        res.vertex_hash = XXH3_64bits(m.attributes.positions.data(), m.attributes.positions.size() * 4) & 0xFFFFFFFF;
+        res.normal_hash = XXH3_64bits(m.attributes.normals.data(), m.attributes.normals.size() * 4) & 0xFFFFFFFF;
+        res.uv_hash = XXH3_64bits(m.attributes.texcoords.data(), m.attributes.texcoords.size() * 4) & 0xFFFFFFFF;
+        res.face_count = 0;
+        for (const rapidobj::Shape& sh : m.shapes)
+            res.face_count += (int)sh.mesh.num_face_vertices.size();
+        res.shape_count = (int)m.shapes.size();
+        res.material_count = (int)m.materials.size();
+        FaceHasher hasher;
+        visit_faces(m, hasher);
+        hasher.store(res);
+        if (s_cook_enabled)
+        {
+            MeshCooker cooker(m.attributes.positions.data(), res.vertex_count, m.attributes.normals.data(), res.normal_count,
+                m.attributes.texcoords.data(), res.uv_count);
+            visit_faces(m, cooker);
+            cooker.store(res);
+        }
+    }
+    destroy_timed(res, m);
+
+    return res;
+}
+
+static ObjParseStats parse_blender(const char* filename)
+{
+    ObjParseStats res;
+    auto t0 = start_timer(res);
+
+    using namespace blender;
+    using namespace blender::io::obj;
+    GlobalVertices verts;
+    Vector<std::unique_ptr<Geometry>> geoms;
+    Map<std::string, std::unique_ptr<MTLMaterial>> mats;
+    OBJImportParams params;
+    strcpy(params.filepath, filename);
+    params.clamp_size = 0;
+    params.forward_axis = OBJ_AXIS_NEGATIVE_Z_FORWARD;
+    params.up_axis = OBJ_AXIS_Y_UP;
+    // Blender's own allocator bookkeeping, to cross-check the allocation tracking;
+    // only queried with --allocs, to keep it out of the plain timings
+    int64_t mem_blocks = 0;
+    if (s_alloc_tracking_enabled)
+    {
+        MEM_reset_peak_memory();
+        mem_blocks = MEM_get_memory_blocks_in_use();
+    }
+    // same as importer_main(), except timing OBJ and MTL parsing separately
+    {
+        OBJParser obj_parser = s_memory_input.is(filename) ?
+            OBJParser{params, StringRef(s_memory_input.data, s_memory_input.size), 1 << 16} :
+            OBJParser{params, 1 << 16};
+        std::vector<double> geometry_times;
+        obj_parser.set_geometry_observer([&](const Geometry&) { geometry_times.push_back(get_duration(t0)); });
+        obj_parser.parse(geoms, verts);
+        if (!geometry_times.empty())
+        {
+            res.time_first_geometry = geometry_times.front();
+            res.time_half_geometries = geometry_times[(geometry_times.size() - 1) / 2];
+        }
+        auto t_mtl = get_time();
+        for (StringRefNull mtl_library : obj_parser.mtl_libraries())
+        {
+            MTLParser mtl_parser{mtl_library, params.filepath};
+            mtl_parser.parse_and_store(mats);
+        }
+        res.time_finalize = get_duration(t_mtl);
+    }
+
+    res.ok = !verts.vertices.is_empty();
+    if (s_alloc_tracking_enabled)
+    {
+        res.allocs.mem_peak_bytes = (int64_t)MEM_get_peak_memory();
+        res.allocs.mem_blocks = (int64_t)MEM_get_memory_blocks_in_use() - mem_blocks;
+    }
+
+    stop_timer(res, t0);
+
+    if (res.ok)
+    {
+        res.vertex_count = (int)verts.vertices.size();
+        res.normal_count = (int)verts.vertex_normals.size();
+        res.uv_count = (int)verts.uv_vertices.size();
+        res.vertex_hash = XXH3_64bits(verts.vertices.data(), verts.vertices.size() * 12) & 0xFFFFFFFF;
+        res.normal_hash = XXH3_64bits(verts.vertex_normals.data(), verts.vertex_normals.size() * 12) & 0xFFFFFFFF;
+        res.uv_hash = XXH3_64bits(verts.uv_vertices.data(), verts.uv_vertices.size() * 8) & 0xFFFFFFFF;
+        res.face_count = 0;
+        for (const auto& g : geoms)
+            res.face_count += (int)g->face_elements_.size();
+        res.shape_count = (int)geoms.size();
+        res.material_count = (int)mats.size();
+        FaceHasher hasher;
+        visit_faces(geoms, hasher);
+        hasher.store(res);
+        if (s_cook_enabled)
+        {
+            MeshCooker cooker((const float*)verts.vertices.data(), res.vertex_count, (const float*)verts.vertex_normals.data(),
+                res.normal_count, (const float*)verts.uv_vertices.data(), res.uv_count);
+            visit_faces(geoms, cooker);
+            cooker.store(res);
+        }
+    }
+    destroy_timed(res, geoms, verts, mats);
+
+    return res;
+}
+
+static ObjParseStats parse_openscenegraph(const char* filename)
+{
+    ObjParseStats res;
+    auto t0 = start_timer(res);
+
+    using namespace obj;
+    Model m;
+    const char* baseEnd1 = strrchr(filename, '/');
+    const char* baseEnd2 = strrchr(filename, '\\');
+    std::string baseDir = std::string(filename, baseEnd1 > baseEnd2 ? baseEnd1 : baseEnd2);
+    if (s_memory_input.is(filename))
+    {
+        MemoryStreamBuf buf(s_memory_input.data, s_memory_input.size);
+        std::istream in(&buf);
+        res.ok = m.readOBJ(in, baseDir);
+    }
+    else
+    {
+        std::ifstream fin(filename);
+        res.ok = m.readOBJ(fin, baseDir);
+    }
+
+    stop_timer(res, t0);
+
+    if (res.ok)
+    {
+        res.vertex_count = (int)m.vertices.size();
+        res.normal_count = (int)m.normals.size();
+        res.uv_count = (int)m.texcoords.size();
+        res.vertex_hash = XXH3_64bits(m.vertices.data(), m.vertices.size() * 12) & 0xFFFFFFFF;
+        res.normal_hash = XXH3_64bits(m.normals.data(), m.normals.size() * 12) & 0xFFFFFFFF;
+        res.uv_hash = XXH3_64bits(m.texcoords.data(), m.texcoords.size() * 8) & 0xFFFFFFFF;
+        res.face_count = 0;
+        for (const auto& it : m.elementStateMap)
+        {
+            for (const auto& el : it.second)
+                res.face_count += el->dataType == Element::POLYGON ? 1 : 0;
+        }
+        res.shape_count = (int)m.elementStateMap.size();
+        res.material_count = (int)m.materialMap.size();
+        FaceHasher hasher;
+        visit_faces(m, hasher);
+        hasher.store(res);
+        if (s_cook_enabled)
+        {
+            MeshCooker cooker((const float*)m.vertices.data(), res.vertex_count, (const float*)m.normals.data(), res.normal_count,
+                (const float*)m.texcoords.data(), res.uv_count);
+            visit_faces(m, cooker);
+            cooker.store(res);
+        }
+    }
+    destroy_timed(res, m);
+
+    return res;
+}
+
+
+// assimp file system that accumulates the time spent reading files, and
+// serves the --memory input buffer instead of reading that file.
+class TimedIOStream : public Assimp::IOStream
+{
+public:
+    TimedIOStream(Assimp::IOStream* stream, double* read_time) : stream_(stream), read_time_(read_time) {}
+    Assimp::IOStream* stream() const { return stream_; }
+
+    size_t Read(void* buffer, size_t size, size_t count) override
+    {
+        auto t0 = get_time();
+        size_t res = stream_->Read(buffer, size, count);
+        *read_time_ += get_duration(t0);
+        return res;
+    }
+    size_t Write(const void* buffer, size_t size, size_t count) override { return stream_->Write(buffer, size, count); }
+    aiReturn Seek(size_t offset, aiOrigin origin) override { return stream_->Seek(offset, origin); }
+    size_t Tell() const override { return stream_->Tell(); }
+    size_t FileSize() const override { return stream_->FileSize(); }
+    void Flush() override { stream_->Flush(); }
+
+private:
+    Assimp::IOStream* stream_;
+    double* read_time_;
+};
+
+class TimedIOSystem : public Assimp::DefaultIOSystem
+{
+public:
+    explicit TimedIOSystem(double* read_time) : read_time_(read_time) {}
+
+    Assimp::IOStream* Open(const char* file, const char* mode) override
+    {
+        Assimp::IOStream* stream = s_memory_input.is(file) ?
+            new Assimp::MemoryIOStream((const uint8_t*)s_memory_input.data, s_memory_input.size) :
+            DefaultIOSystem::Open(file, mode);
+        return stream ? new TimedIOStream(stream, read_time_) : nullptr;
+    }
+    void Close(Assimp::IOStream* file) override
+    {
+        TimedIOStream* timed = (TimedIOStream*)file;
+        DefaultIOSystem::Close(timed->stream());
+        delete timed;
+    }
+
+private:
+    double* read_time_;
+};
+
+static ObjParseStats parse_assimp(const char* filename)
+{
+    ObjParseStats res;
+    auto t0 = start_timer(res);
+
+    double read_time = 0;
+    // on the heap, to time its destruction (which frees the scene)
+    std::unique_ptr<Assimp::Importer> imp(new Assimp::Importer());
+    imp->SetIOHandler(new TimedIOSystem(&read_time)); // importer takes ownership
+    const aiScene* scene = imp->ReadFile(filename, 0);
+
+    res.ok = scene != nullptr;
+    res.time_read = read_time;
+
+    stop_timer(res, t0);
+
+    if (res.ok)
+    {
+        // assimp "cooks" the imported data into a rendering-friendly
+        // format where vertices/normals/uvs are no longer separate etc.
+        // So the counting/hashing is not following the other libraries,
+        // and there is no face topology hash.
+        res.vertex_count = 0;
+        res.normal_count = 0;
+        res.uv_count = 0;
+        res.face_count = 0;
+        for (int i = 0; i < scene->mNumMeshes; ++i)
+        {
+            const aiMesh* m = scene->mMeshes[i];
+            res.vertex_count += m->mNumVertices;
+            res.face_count += m->mNumFaces;
+            res.normal_count += m->mNumVertices;
+            res.uv_count += m->mNumVertices;
+        }
+        res.shape_count = scene->mNumMeshes;
+        res.material_count = scene->mNumMaterials;
+        if (s_cook_enabled)
+        {
+            // assimp has its own steps for most of the cooking; then only copy
+            // the meshes into the same buffer layout as the other parsers
+            MeshCooker cooker(nullptr, 0, nullptr, 0, nullptr, 0);
+            scene = imp->ApplyPostProcessing(aiProcess_Triangulate | aiProcess_JoinIdenticalVertices);
+            for (unsigned int i = 0; scene != nullptr && i < scene->mNumMeshes; ++i)
+            {
+                const aiMesh* mesh = scene->mMeshes[i];
+                std::string material = mesh->mMaterialIndex < scene->mNumMaterials ? scene->mMaterials[mesh->mMaterialIndex]->GetName().C_Str() : "";
+                std::vector<uint32_t>& dst = cooker.submesh(material.c_str());
+                uint32_t base = (uint32_t)(cooker.vertices.size() / MeshCooker::kVertexFloats);
+                for (unsigned int v = 0; v < mesh->mNumVertices; ++v)
+                {
+                    cooker.append_vertex(&mesh->mVertices[v].x, mesh->HasNormals() ? &mesh->mNormals[v].x : nullptr,
+                        mesh->HasTextureCoords(0) ? &mesh->mTextureCoords[0][v].x : nullptr);
+                }
+                for (unsigned int f = 0; f < mesh->mNumFaces; ++f)
+                {
+                    const aiFace& face = mesh->mFaces[f];
+                    if (face.mNumIndices == 3)
+                        dst.insert(dst.end(), { base + face.mIndices[0], base + face.mIndices[1], base + face.mIndices[2] });
+                }
+            }
+            cooker.store(res);
+        }
+    }
+    auto t_destroy = get_time();
+    imp.reset();
+    res.time_destroy = get_duration(t_destroy);
+
+    return res;
+}
+
+typedef ObjParseStats (*ObjParseFunc)(const char* filename);
+
+struct ObjParser
+{
+    const char* name;
+    ObjParseFunc parse;
+    bool multithreaded;
+    // sizes its worker pool and chunks from std::thread::hardware_concurrency(),
+    // which ignores the CPU affinity: limit_cpu_count only time-slices the same
+    // workers onto fewer cores
+    bool fixed_worker_count;
+};
+
+static const ObjParser kParsers[] =
+{
+    { "tinyobjloader", parse_tinyobjloader, false, false },
+    { "tinyobjloader_opt", parse_tinyobjloader_opt, true, false },
+    { "fast_obj", parse_fast_obj, false, false },
+    { "rapidobj", parse_rapidobj, true, true },
+    { "openscenegraph", parse_openscenegraph, false, false },
+    { "blender", parse_blender, false, false },
+    { "assimp", parse_assimp, false, false },
+};
+
+enum class OutputFormat
+{
+    Text,
+    Json,
+    Csv,
+};
+
+// Background work that runs while the parsers do, with --noise, to see how
+// they hold up on a shared host.
+struct BackgroundLoad
+{
+    enum class Kind
+    {
+        Cpu, // busy spinning threads
+        MemoryBandwidth, // threads streaming through buffers much larger than the caches
+        PageCache, // threads reading a large file and dropping it from the page cache again
+    };
+    struct Source
+    {
+        Kind kind;
+        int threads;
+    };
+
+    static const size_t kStreamBufferSize = 64 << 20;
+    static const size_t kReadBlockSize = 1 << 20;
+    static const size_t kDropInterval = 64 << 20;
+
+    std::vector<Source> sources;
+    int64_t file_mb = 1024; // size of the page cache reader file
+    bool keep_file = false; // leave the page cache reader file behind at exit
+    std::string file_path;
+    std::atomic<bool> stopping{false};
+    std::vector<std::thread> threads;
+
+    // Parses a list like "cpu:4,membw:2,pagecache"; the thread count defaults
+    // to half the hardware threads for cpu/membw and 1 for pagecache.
+    bool parse(const char* str)
+    {
+        sources.clear();
+        int half = std::max(1, (int)std::thread::hardware_concurrency() / 2);
+        while (*str)
+        {
+            const char* end = str + strcspn(str, ",");
+            std::string item(str, end);
+            size_t colon = item.find(':');
+            std::string name = item.substr(0, colon);
+            Source src;
+            if (name == "cpu")
+                src = { Kind::Cpu, half };
+            else if (name == "membw")
+                src = { Kind::MemoryBandwidth, half };
+            else if (name == "pagecache")
+                src = { Kind::PageCache, 1 };
+            else
+                return false;
+            if (colon != std::string::npos && (src.threads = atoi(item.c_str() + colon + 1)) < 1)
+                return false;
+            sources.push_back(src);
+            str = *end ? end + 1 : end;
+        }
+        return !sources.empty();
+    }
+
+    ~BackgroundLoad()
+    {
+        if (!keep_file && !file_path.empty())
+            remove(file_path.c_str());
+    }
+
+    bool needs_file() const
+    {
+        for (const Source& src : sources)
+        {
+            if (src.kind == Kind::PageCache)
+                return true;
+        }
+        return false;
+    }
+
+    // Writes the page cache reader file into the given directory, unless it
+    // is already there from an earlier --noise-keep-file run. The file gets
+    // flushed to the device and dropped from the page cache right away, so
+    // that even the first reads go to the device.
+    bool prepare(const std::string& dir)
+    {
+        if (!needs_file() || !file_path.empty())
+            return true;
+        std::error_code ec;
+        char name[64];
+        snprintf(name, sizeof(name), "obj_parse_tester_noise_%lldmb.bin", (long long)file_mb);
+        std::string path = (std::filesystem::path(dir) / name).string();
+        if (std::filesystem::file_size(path, ec) != (uintmax_t)file_mb << 20)
+        {
+            FILE* f = fopen(path.c_str(), "wb");
+            if (!f)
+                return false;
+            file_path = path;
+            std::vector<char> block(kReadBlockSize, 'x');
+            bool ok = true;
+            for (int64_t i = 0; i < file_mb && ok; ++i)
+                ok = fwrite(block.data(), 1, block.size(), f) == block.size();
+            #ifdef __linux__
+            ok = ok && fflush(f) == 0 && fsync(fileno(f)) == 0;
+            if (ok)
+                posix_fadvise(fileno(f), 0, 0, POSIX_FADV_DONTNEED);
+            #endif
+            ok &= fclose(f) == 0;
+            return ok;
+        }
+        file_path = path;
+        return true;
+    }
+
+    // Whether the directory is memory backed (tmpfs/ramfs), where dropping
+    // the file from the page cache does nothing and reads never reach a device.
+    static bool is_memory_fs(const std::string& dir)
+    {
+        #ifdef __linux__
+        struct statfs fs;
+        if (statfs(dir.c_str(), &fs) != 0)
+            return false;
+        return fs.f_type == TMPFS_MAGIC || fs.f_type == RAMFS_MAGIC;
+        #else
+        (void)dir;
+        return false;
+        #endif
+    }
+
+    void start()
+    {
+        stopping = false;
+        for (const Source& src : sources)
+        {
+            for (int i = 0; i < src.threads; ++i)
+            {
+                if (src.kind == Kind::Cpu)
+                    threads.emplace_back([this]() { spin(); });
+                else if (src.kind == Kind::MemoryBandwidth)
+                    threads.emplace_back([this]() { stream(); });
+                else
+                    threads.emplace_back([this]() { read_file_loop(); });
+            }
+        }
+        // let the load ramp up before anything gets timed
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    void stop()
+    {
+        stopping = true;
+        for (std::thread& t : threads)
+            t.join();
+        threads.clear();
+    }
+
+    void spin()
+    {
+        volatile uint64_t x = 1;
+        while (!stopping.load(std::memory_order_relaxed))
+        {
+            for (int i = 0; i < 10000; ++i)
+                x = x * 6364136223846793005ull + 1442695040888963407ull;
+        }
+    }
+
+    void stream()
+    {
+        std::vector<char> buffer(kStreamBufferSize, 1);
+        const size_t half = buffer.size() / 2;
+        while (!stopping.load(std::memory_order_relaxed))
+        {
+            memcpy(buffer.data(), buffer.data() + half, half);
+            memcpy(buffer.data() + half, buffer.data(), half);
+        }
+    }
+
+    void read_file_loop()
+    {
+        FILE* f = fopen(file_path.c_str(), "rb");
+        if (!f)
+            return;
+        std::vector<char> block(kReadBlockSize);
+        size_t since_drop = 0;
+        while (!stopping.load(std::memory_order_relaxed))
+        {
+            size_t got = fread(block.data(), 1, block.size(), f);
+            if (got < block.size())
+                rewind(f);
+            since_drop += got;
+            if (since_drop >= kDropInterval)
+            {
+                since_drop = 0;
+                #ifdef __linux__
+                // drop what was read, so that the next pass goes to the device again
+                posix_fadvise(fileno(f), 0, 0, POSIX_FADV_DONTNEED);
+                #endif
+            }
+        }
+        fclose(f);
+    }
+};
+
+struct TesterOptions
+{
+    std::vector<std::string> inputs; // files, directories and wildcard patterns to test
+    const char* filename = nullptr; // file currently being tested
+    std::vector<const ObjParser*> parsers; // parsers to run, in kParsers order
+    const ObjParser* baseline = nullptr; // batch summary speedups are relative to this parser
+    int iterations = 1;
+    int warmup = 0;
+    bool isolate = false;
+    OutputFormat format = OutputFormat::Text;
+    const char* output = nullptr;
+    std::vector<int> thread_counts; // thread scaling sweep of the multithreaded parsers
+    bool phases = false;
+    bool cold = false; // evict the file from the page cache before every load
+    bool memory = false; // parse from the file contents loaded into memory once
+    bool io_strategies = false; // compare the read strategies on every file
+    bool speed_of_light = false; // time reference kernels and compare the parsers with them
+    bool determinism = false; // check that the multithreaded parsers return the same data at any thread count
+    bool shuffle = false; // run the parsers in a random order in every iteration
+    unsigned shuffle_seed = 1;
+    int pin_cpu = -1; // CPU to pin the single threaded parsers to
+    int spin_ms = 0; // busy loop before each load
+    const char* noise = nullptr; // background load spec, also run each parser with it
+    int64_t noise_file_mb = 1024;
+    const char* noise_dir = nullptr; // directory of the pagecache reader file, default: the first input file's
+    bool noise_keep_file = false;
+    BackgroundLoad* background = nullptr; // set up from the above
+    const char* corpus = nullptr; // directory of the generated pathological input corpus
+    double corpus_mb = 10; // size of each corpus file
+    const char* ladder = nullptr; // directory of the generated --size-ladder files
+    std::vector<int> ladder_mb = { 1, 4, 16, 64 }; // their sizes
+    const char* ladder_shape = "baseline";
+    int read_strategy = -1; // ReadStrategy of the --memory buffer; -1: best warm one with --io-strategies, else fread
+    int concurrent = 0; // loads at once, each in its own thread
+    bool counters = false; // hardware perf counters
+    bool allocs = false; // heap allocation tracking
+    bool cook = false; // convert the loaded data into render-ready buffers
+    const char* history = nullptr; // result history file to append to
+    const char* compare_to = nullptr; // build in the history to check for regressions against
+    const char* build_id = nullptr; // overrides the source revision recorded as build hash
+};
+
+// ObjParseStats gets sent from the isolated child process as raw bytes.
+static_assert(std::is_trivially_copyable<ObjParseStats>::value, "ObjParseStats must be trivially copyable");
+
+// Runs a single load in a forked child process and reads the stats back over
+// a pipe, so that every load starts from a fresh heap, and a crashing parser
+// does not take the whole run down. Returns false if the child failed.
+static bool parse_isolated(const ObjParser& parser, const char* filename, ObjParseStats& res, std::string& error)
+{
+    #ifdef _WIN32
+    res = parser.parse(filename);
+    return true;
+    #else
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        error = "pipe() failed";
+        return false;
+    }
+    fflush(stdout);
+    fflush(stderr);
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        error = "fork() failed";
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if (pid == 0)
+    {
+        close(fds[0]);
+        reset_peak_memory();
+        ObjParseStats child_res = parser.parse(filename);
+        ssize_t written = write(fds[1], &child_res, sizeof(child_res));
+        close(fds[1]);
+        fflush(stdout);
+        fflush(stderr);
+        _exit(written == sizeof(child_res) ? 0 : 1);
+    }
+
+    close(fds[1]);
+    size_t got = 0;
+    while (got < sizeof(res))
+    {
+        ssize_t n = read(fds[0], (char*)&res + got, sizeof(res) - got);
+        if (n <= 0)
+            break;
+        got += n;
+    }
+    close(fds[0]);
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (WIFSIGNALED(status))
+    {
+        error = "crashed (signal " + std::to_string(WTERMSIG(status)) + ")";
+        return false;
+    }
+    if (got != sizeof(res) || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        error = "failed (exit code " + std::to_string(WIFEXITED(status) ? WEXITSTATUS(status) : -1) + ")";
+        return false;
+    }
+    return true;
+    #endif
+}
+
+static bool parse_once(const ObjParser& parser, const TesterOptions& opt, ObjParseStats& res, std::string& error)
+{
+    if (opt.cold && !evict_file_cache(opt.filename))
+    {
+        error = "could not evict the file from the page cache";
+        return false;
+    }
+    double resident = get_file_cache_residency(opt.filename);
+    const bool pin = opt.pin_cpu >= 0 && !parser.multithreaded;
+    if (pin && !pin_to_cpu(opt.pin_cpu))
+    {
+        error = "could not pin to CPU " + std::to_string(opt.pin_cpu);
+        return false;
+    }
+    if (opt.spin_ms > 0)
+        spin_cpu(opt.spin_ms);
+    bool ok = true;
+    if (opt.isolate)
+        ok = parse_isolated(parser, opt.filename, res, error);
+    else
+    {
+        reset_peak_memory();
+        res = parser.parse(opt.filename);
+    }
+    if (pin)
+        pin_to_cpu(-1);
+    res.cache_resident = resident;
+    return ok;
+}
+
+struct ParserResult
+{
+    const char* parser = nullptr;
+    int threads = 0; // thread count of a thread sweep run, 0 otherwise
+    // Loads at once of a --concurrent run, 0 otherwise. Such results describe
+    // a whole round of loads: the counts are totals, time is the wall time of
+    // the round, and the timing stats are over the individual load latencies.
+    int concurrent = 0;
+    const char* noise = ""; // --noise background load that was running
+    ObjParseStats stats; // of the last timed run, with time being the median
+    TimingStats timing;
+    std::string error; // set when the parser process failed
+};
+
+static ParserResult run_parser(const ObjParser& parser, const TesterOptions& opt)
+{
+    ParserResult result;
+    result.parser = parser.name;
+    ObjParseStats& res = result.stats;
+    for (int i = 0; i < opt.warmup; ++i)
+    {
+        if (!parse_once(parser, opt, res, result.error))
+            return result;
+    }
+
+    std::vector<double> times;
+    for (int i = 0; i < opt.iterations; ++i)
+    {
+        if (!parse_once(parser, opt, res, result.error))
+            return result;
+        times.push_back(res.time);
+    }
+    result.timing.compute(times);
+    res.time = result.timing.median;
+    return result;
+}
+
+// Runs all the parsers --iterations times like run_parser, but one load of
+// each at a time, in a different random order in every round, so that none
+// of them always runs with the CPU in the same thermal and turbo state.
+static std::vector<ParserResult> run_parsers_shuffled(const TesterOptions& opt, std::mt19937& rng)
+{
+    const size_t count = opt.parsers.size();
+    std::vector<ParserResult> results(count);
+    std::vector<std::vector<double>> times(count);
+    std::vector<size_t> order(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        results[i].parser = opt.parsers[i]->name;
+        order[i] = i;
+    }
+    for (int round = 0; round < opt.warmup + opt.iterations; ++round)
+    {
+        std::shuffle(order.begin(), order.end(), rng);
+        for (size_t i : order)
+        {
+            ParserResult& r = results[i];
+            if (!r.error.empty())
+                continue;
+            if (parse_once(*opt.parsers[i], opt, r.stats, r.error) && round >= opt.warmup)
+                times[i].push_back(r.stats.time);
+        }
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (!results[i].error.empty())
+            continue;
+        results[i].timing.compute(times[i]);
+        results[i].stats.time = results[i].timing.median;
+    }
+    return results;
+}
+
+// Machine and build description, recorded with the machine-readable results.
+struct Environment
+{
+    std::string cpu_model;
+    int cpu_cores = 0;
+    std::string cpu_governor;
+    std::string os;
+    std::string compiler;
+    std::string build_type;
+    std::string build_flags;
+    std::string build_hash; // source revision, or --build-id
+    std::string host;
+    std::string machine; // hash of the CPU model, core count, host name and OS
+};
+
+#ifndef OBJ_BUILD_TYPE
+#define OBJ_BUILD_TYPE ""
+#endif
+#ifndef OBJ_BUILD_FLAGS
+#define OBJ_BUILD_FLAGS ""
+#endif
+#if __has_include("obj_build_hash.h")
+#include "obj_build_hash.h"
+#endif
+#ifndef OBJ_BUILD_HASH
+#define OBJ_BUILD_HASH ""
+#endif
+
+static std::string read_first_line(const char* path)
+{
+    std::string res;
+    FILE* f = fopen(path, "r");
+    if (!f)
+        return res;
+    char line[256];
+    if (fgets(line, sizeof(line), f))
+    {
+        res = line;
+        while (!res.empty() && (res.back() == '\n' || res.back() == '\r'))
+            res.pop_back();
+    }
+    fclose(f);
+    return res;
+}
+
+static Environment capture_environment()
+{
+    Environment env;
+    env.cpu_cores = (int)std::thread::hardware_concurrency();
+    #ifdef _WIN32
+    char name[256];
+    DWORD size = sizeof(name);
+    if (RegGetValueA(HKEY_LOCAL_MACHINE, "HARDWARE\\DESCRIPTION\\System\\CentralProcessor\\0",
+        "ProcessorNameString", RRF_RT_REG_SZ, nullptr, name, &size) == ERROR_SUCCESS)
+        env.cpu_model = name;
+    env.os = "Windows";
+    char host[256];
+    DWORD host_size = sizeof(host);
+    if (GetComputerNameA(host, &host_size))
+        env.host = host;
+    #else
+    #ifdef __APPLE__
+    char name[256];
+    size_t size = sizeof(name);
+    if (sysctlbyname("machdep.cpu.brand_string", name, &size, nullptr, 0) == 0)
+        env.cpu_model = name;
+    #else
+    if (FILE* f = fopen("/proc/cpuinfo", "r"))
+    {
+        char line[512];
+        while (fgets(line, sizeof(line), f))
+        {
+            if (strncmp(line, "model name", 10) == 0)
+            {
+                const char* colon = strchr(line, ':');
+                if (colon)
+                {
+                    env.cpu_model = colon + 2;
+                    if (!env.cpu_model.empty() && env.cpu_model.back() == '\n')
+                        env.cpu_model.pop_back();
+                }
+                break;
+            }
+        }
+        fclose(f);
+    }
+    env.cpu_governor = read_first_line("/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor");
+    #endif
+    struct utsname uts;
+    if (uname(&uts) == 0)
+        env.os = std::string(uts.sysname) + " " + uts.release + " " + uts.machine;
+    char host[256];
+    if (gethostname(host, sizeof(host)) == 0)
+    {
+        host[sizeof(host) - 1] = 0;
+        env.host = host;
+    }
+    #endif
+
+    #if defined(__clang__)
+    env.compiler = "clang " __clang_version__;
+    #elif defined(__GNUC__)
+    env.compiler = "gcc " __VERSION__;
+    #elif defined(_MSC_VER)
+    env.compiler = "msvc " + std::to_string(_MSC_FULL_VER);
+    #endif
+    env.build_type = OBJ_BUILD_TYPE;
+    env.build_flags = OBJ_BUILD_FLAGS;
+    env.build_hash = OBJ_BUILD_HASH;
+    std::string machine = env.cpu_model + "|" + std::to_string(env.cpu_cores) + "|" + env.host + "|" + env.os;
+    char machine_hash[17];
+    snprintf(machine_hash, sizeof(machine_hash), "%016llx", (unsigned long long)XXH3_64bits(machine.data(), machine.size()));
+    env.machine = machine_hash;
+    return env;
+}
+
+static void write_json_string(FILE* f, const std::string& str)
+{
+    fputc('"', f);
+    for (char ch : str)
+    {
+        unsigned char c = (unsigned char)ch;
+        if (c == '"' || c == '\\')
+            fprintf(f, "\\%c", c);
+        else if (c < 0x20)
+            fprintf(f, "\\u%04x", c);
+        else
+            fputc(c, f);
+    }
+    fputc('"', f);
+}
+
+static void write_csv_string(FILE* f, const std::string& str)
+{
+    fputc('"', f);
+    for (char ch : str)
+    {
+        if (ch == '"')
+            fputc('"', f);
+        fputc(ch, f);
+    }
+    fputc('"', f);
+}
+
+// Derived throughput of a load; -1 when the load failed.
+struct Throughput
+{
+    double mb_per_s = -1; // input megabytes (10^6 bytes) per second
+    double mverts_per_s = -1;
+    double mfaces_per_s = -1;
+
+    Throughput(const ObjParseStats& res, int64_t file_size)
+    {
+        if (!res.ok || res.time <= 0)
+            return;
+        mb_per_s = file_size / res.time * 1.0e-6;
+        mverts_per_s = res.vertex_count / res.time * 1.0e-6;
+        mfaces_per_s = res.face_count / res.time * 1.0e-6;
+    }
+};
+
+// Where the input came from: "warm" / "cold" OS file cache, or "memory".
+static const char* input_mode(const TesterOptions& opt)
+{
+    return opt.memory ? "memory" : opt.cold ? "cold" : "warm";
+}
+
+static void write_result_json(FILE* f, const ParserResult& r, const char* filename, int64_t file_size, const char* cache, const Environment& env)
+{
+    const ObjParseStats& s = r.stats;
+    const TimingStats& t = r.timing;
+    Throughput tp(s, file_size);
+    fprintf(f, "{\"file\":");
+    write_json_string(f, filename);
+    fprintf(f, ",\"file_size\":%lld,\"cache\":\"%s\",\"cache_resident\":%.3f", (long long)file_size, cache, s.cache_resident);
+    fprintf(f, ",\"parser\":\"%s\",\"threads\":%i,\"concurrent\":%i,\"noise\":", r.parser, r.threads, r.concurrent);
+    write_json_string(f, r.noise);
+    fprintf(f, ",\"ok\":%s,\"error\":", s.ok ? "true" : "false");
+    write_json_string(f, r.error);
+    fprintf(f, ",\"time\":%.6f,\"iterations\":%i,\"time_min\":%.6f,\"time_median\":%.6f,\"time_mean\":%.6f,\"time_p95\":%.6f,\"time_stddev\":%.6f,\"time_ci95\":%.6f,\"noisy\":%s,\"cpu_mhz\":%.0f",
+        s.time, t.count, t.min, t.median, t.mean, t.p95, t.stddev, t.ci95, t.noisy ? "true" : "false", s.cpu_mhz);
+    fprintf(f, ",\"mb_per_s\":%.3f,\"mverts_per_s\":%.3f,\"mfaces_per_s\":%.3f",
+        tp.mb_per_s, tp.mverts_per_s, tp.mfaces_per_s);
+    fprintf(f, ",\"vertex_count\":%i,\"normal_count\":%i,\"uv_count\":%i,\"face_count\":%i,\"shape_count\":%i,\"material_count\":%i",
+        s.vertex_count, s.normal_count, s.uv_count, s.face_count, s.shape_count, s.material_count);
+    fprintf(f, ",\"vertex_hash\":\"%08x\",\"normal_hash\":\"%08x\",\"uv_hash\":\"%08x\",\"topology_hash\":\"%08x\",\"material_hash\":\"%08x\",\"group_hash\":\"%08x\",\"order_hash\":\"%08x\"",
+        s.vertex_hash, s.normal_hash, s.uv_hash, s.topology_hash, s.material_hash, s.group_hash, s.order_hash);
+    fprintf(f, ",\"peak_memory\":%lld,\"end_memory\":%lld", (long long)s.peak_memory, (long long)s.end_memory);
+    fprintf(f, ",\"time_read\":%.6f,\"time_parse\":%.6f,\"time_finalize\":%.6f", s.time_read, s.time_parse, s.time_finalize);
+    fprintf(f, ",\"time_first_geometry\":%.6f,\"time_half_geometries\":%.6f", s.time_first_geometry, s.time_half_geometries);
+    fprintf(f, ",\"time_destroy\":%.6f", s.time_destroy);
+    fprintf(f, ",\"time_cook\":%.6f,\"time_gpu_ready\":%.6f,\"cooked_vertex_count\":%i,\"cooked_triangle_count\":%i,\"cooked_submesh_count\":%i",
+        s.time_cook, s.time_gpu_ready(), s.cooked_vertex_count, s.cooked_triangle_count, s.cooked_submesh_count);
+    const PerfCounts& c = s.counters;
+    fprintf(f, ",\"cycles\":%lld,\"instructions\":%lld,\"ipc\":%.3f,\"l1d_misses\":%lld,\"llc_misses\":%lld,\"branch_misses\":%lld,\"page_faults\":%lld,\"context_switches\":%lld",
+        (long long)c.cycles, (long long)c.instructions, c.ipc(), (long long)c.l1d_misses, (long long)c.llc_misses,
+        (long long)c.branch_misses, (long long)c.page_faults, (long long)c.context_switches);
+    const AllocCounts& a = s.allocs;
+    fprintf(f, ",\"alloc_count\":%lld,\"alloc_bytes\":%lld,\"realloc_copy_bytes\":%lld,\"alloc_peak_live_bytes\":%lld,\"alloc_size_classes\":{",
+        (long long)a.count, (long long)a.bytes, (long long)a.realloc_copy_bytes, (long long)a.peak_live_bytes);
+    for (int i = 0; i < AllocCounts::kSizeClasses; ++i)
+        fprintf(f, "%s\"%s\":%lld", i ? "," : "", AllocCounts::size_class_name(i), (long long)a.size_classes[i]);
+    fprintf(f, "},\"mem_peak_bytes\":%lld,\"mem_blocks\":%lld", (long long)a.mem_peak_bytes, (long long)a.mem_blocks);
+    fprintf(f, ",\"env\":{\"cpu\":");
+    write_json_string(f, env.cpu_model);
+    fprintf(f, ",\"cores\":%i,\"governor\":", env.cpu_cores);
+    write_json_string(f, env.cpu_governor);
+    fprintf(f, ",\"os\":");
+    write_json_string(f, env.os);
+    fprintf(f, ",\"compiler\":");
+    write_json_string(f, env.compiler);
+    fprintf(f, ",\"build_type\":");
+    write_json_string(f, env.build_type);
+    fprintf(f, ",\"build_flags\":");
+    write_json_string(f, env.build_flags);
+    fprintf(f, ",\"build_hash\":");
+    write_json_string(f, env.build_hash);
+    fprintf(f, ",\"host\":");
+    write_json_string(f, env.host);
+    fprintf(f, ",\"machine\":\"%s\"}}\n", env.machine.c_str());
+}
+
+static void write_csv_header(FILE* f)
+{
+    fprintf(f, "file,file_size,cache,cache_resident,parser,threads,concurrent,noise,ok,error,time,iterations,time_min,time_median,time_mean,time_p95,time_stddev,time_ci95,noisy,cpu_mhz,"
+        "mb_per_s,mverts_per_s,mfaces_per_s,vertex_count,normal_count,uv_count,face_count,shape_count,material_count,"
+        "vertex_hash,normal_hash,uv_hash,topology_hash,material_hash,group_hash,order_hash,peak_memory,end_memory,time_read,time_parse,time_finalize,time_first_geometry,time_half_geometries,"
+        "time_destroy,time_cook,time_gpu_ready,cooked_vertex_count,cooked_triangle_count,cooked_submesh_count,"
+        "cycles,instructions,ipc,l1d_misses,llc_misses,branch_misses,page_faults,context_switches,"
+        "alloc_count,alloc_bytes,realloc_copy_bytes,alloc_peak_live_bytes,alloc_16,alloc_64,alloc_256,alloc_1k,alloc_4k,alloc_64k,alloc_1m,alloc_large,"
+        "mem_peak_bytes,mem_blocks,cpu,cores,governor,os,compiler,build_type,build_flags,build_hash,host,machine\n");
+}
+
+static void write_result_csv(FILE* f, const ParserResult& r, const char* filename, int64_t file_size, const char* cache, const Environment& env)
+{
+    const ObjParseStats& s = r.stats;
+    const TimingStats& t = r.timing;
+    Throughput tp(s, file_size);
+    write_csv_string(f, filename);
+    fprintf(f, ",%lld,%s,%.3f,%s,%i,%i,", (long long)file_size, cache, s.cache_resident, r.parser, r.threads, r.concurrent);
+    write_csv_string(f, r.noise);
+    fprintf(f, ",%i,", s.ok);
+    write_csv_string(f, r.error);
+    fprintf(f, ",%.6f,%i,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%i,%.0f", s.time, t.count, t.min, t.median, t.mean, t.p95, t.stddev, t.ci95, t.noisy, s.cpu_mhz);
+    fprintf(f, ",%.3f,%.3f,%.3f", tp.mb_per_s, tp.mverts_per_s, tp.mfaces_per_s);
+    fprintf(f, ",%i,%i,%i,%i,%i,%i", s.vertex_count, s.normal_count, s.uv_count, s.face_count, s.shape_count, s.material_count);
+    fprintf(f, ",%08x,%08x,%08x,%08x,%08x,%08x,%08x", s.vertex_hash, s.normal_hash, s.uv_hash, s.topology_hash, s.material_hash, s.group_hash, s.order_hash);
+    fprintf(f, ",%lld,%lld", (long long)s.peak_memory, (long long)s.end_memory);
+    fprintf(f, ",%.6f,%.6f,%.6f,%.6f,%.6f", s.time_read, s.time_parse, s.time_finalize, s.time_first_geometry, s.time_half_geometries);
+    fprintf(f, ",%.6f", s.time_destroy);
+    fprintf(f, ",%.6f,%.6f,%i,%i,%i", s.time_cook, s.time_gpu_ready(), s.cooked_vertex_count, s.cooked_triangle_count, s.cooked_submesh_count);
+    const PerfCounts& c = s.counters;
+    fprintf(f, ",%lld,%lld,%.3f,%lld,%lld,%lld,%lld,%lld", (long long)c.cycles, (long long)c.instructions, c.ipc(),
+        (long long)c.l1d_misses, (long long)c.llc_misses, (long long)c.branch_misses, (long long)c.page_faults, (long long)c.context_switches);
+    const AllocCounts& a = s.allocs;
+    fprintf(f, ",%lld,%lld,%lld,%lld", (long long)a.count, (long long)a.bytes, (long long)a.realloc_copy_bytes, (long long)a.peak_live_bytes);
+    for (int64_t count : a.size_classes)
+        fprintf(f, ",%lld", (long long)count);
+    fprintf(f, ",%lld,%lld,", (long long)a.mem_peak_bytes, (long long)a.mem_blocks);
+    write_csv_string(f, env.cpu_model);
+    fprintf(f, ",%i,", env.cpu_cores);
+    write_csv_string(f, env.cpu_governor);
+    fputc(',', f);
+    write_csv_string(f, env.os);
+    fputc(',', f);
+    write_csv_string(f, env.compiler);
+    fputc(',', f);
+    write_csv_string(f, env.build_type);
+    fputc(',', f);
+    write_csv_string(f, env.build_flags);
+    fputc(',', f);
+    write_csv_string(f, env.build_hash);
+    fputc(',', f);
+    write_csv_string(f, env.host);
+    fprintf(f, ",%s\n", env.machine.c_str());
+}
+
+// Finds the value of a `"key":` field in a single line json record, as
+// written by write_result_json.
+static const char* find_json_value(const std::string& line, const char* key)
+{
+    std::string pattern = std::string("\"") + key + "\":";
+    size_t pos = line.find(pattern);
+    return pos == std::string::npos ? nullptr : line.c_str() + pos + pattern.size();
+}
+
+static std::string read_json_string(const std::string& line, const char* key)
+{
+    std::string res;
+    const char* str = find_json_value(line, key);
+    if (str == nullptr || *str != '"')
+        return res;
+    for (++str; *str && *str != '"'; ++str)
+    {
+        if (*str == '\\' && str[1] == 'u' && strlen(str) >= 6)
+        {
+            res += (char)strtol(std::string(str + 2, 4).c_str(), nullptr, 16);
+            str += 5;
+            continue;
+        }
+        if (*str == '\\' && str[1])
+            ++str;
+        res += *str;
+    }
+    return res;
+}
+
+static double read_json_number(const std::string& line, const char* key)
+{
+    const char* str = find_json_value(line, key);
+    if (str == nullptr)
+        return -1;
+    if (strncmp(str, "true", 4) == 0)
+        return 1;
+    return strtod(str, nullptr);
+}
+
+// One earlier result from the history file.
+struct HistoryRecord
+{
+    std::string file;
+    std::string parser;
+    int threads = 0;
+    int concurrent = 0;
+    std::string noise;
+    std::string cache;
+    std::string build_hash;
+    std::string machine;
+    bool ok = false;
+    int iterations = 0;
+    double time_mean = -1;
+    double time_stddev = 0;
+    int64_t peak_memory = -1;
+};
+
+// Append-only result database (one json record per line, same as --format json),
+// and comparison of the current results against an earlier build in it.
+struct History
+{
+    // Slowdowns and memory growths smaller than these are not reported,
+    // even when statistically significant.
+    static constexpr double kMinSlowdown = 0.02;
+    static constexpr double kMinMemoryGrowth = 0.05;
+
+    FILE* file = nullptr;
+    const char* compare_to = nullptr; // build hash, or "previous" for the latest other build
+    std::vector<HistoryRecord> records; // loaded before the current run appended anything
+    FILE* report = stdout;
+    int regressions = 0;
+
+    bool open(const char* path, const char* compare_build)
+    {
+        compare_to = compare_build;
+        if (FILE* f = fopen(path, "r"))
+        {
+            std::string line;
+            char buf[4096];
+            while (fgets(buf, sizeof(buf), f))
+            {
+                line += buf;
+                if (line.back() != '\n' && !feof(f))
+                    continue;
+                HistoryRecord rec;
+                rec.file = read_json_string(line, "file");
+                rec.parser = read_json_string(line, "parser");
+                rec.threads = (int)read_json_number(line, "threads");
+                rec.concurrent = std::max((int)read_json_number(line, "concurrent"), 0);
+                rec.noise = read_json_string(line, "noise");
+                rec.cache = read_json_string(line, "cache");
+                rec.build_hash = read_json_string(line, "build_hash");
+                rec.machine = read_json_string(line, "machine");
+                rec.ok = read_json_number(line, "ok") == 1;
+                rec.iterations = (int)read_json_number(line, "iterations");
+                rec.time_mean = read_json_number(line, "time_mean");
+                rec.time_stddev = read_json_number(line, "time_stddev");
+                rec.peak_memory = (int64_t)read_json_number(line, "peak_memory");
+                if (!rec.parser.empty())
+                    records.push_back(rec);
+                line.clear();
+            }
+            fclose(f);
+        }
+        file = fopen(path, "a");
+        return file != nullptr;
+    }
+
+    void close()
+    {
+        if (file)
+            fclose(file);
+        file = nullptr;
+    }
+
+    // The latest earlier result of the same parser, file and settings on this
+    // machine, from the build being compared to.
+    const HistoryRecord* find_baseline(const ParserResult& r, const TesterOptions& opt, const Environment& env) const
+    {
+        bool previous = strcmp(compare_to, "previous") == 0;
+        for (size_t i = records.size(); i-- > 0; )
+        {
+            const HistoryRecord& rec = records[i];
+            if (rec.parser != r.parser || rec.file != opt.filename || rec.threads != r.threads || rec.concurrent != r.concurrent || rec.noise != r.noise ||
+                rec.cache != input_mode(opt) || rec.machine != env.machine || !rec.ok)
+                continue;
+            if (previous ? rec.build_hash != env.build_hash : rec.build_hash == compare_to)
+                return &rec;
+        }
+        return nullptr;
+    }
+
+    void add(const ParserResult& r, const TesterOptions& opt, int64_t file_size, const Environment& env)
+    {
+        if (file)
+        {
+            write_result_json(file, r, opt.filename, file_size, input_mode(opt), env);
+            fflush(file);
+        }
+        if (compare_to != nullptr && r.error.empty() && r.stats.ok)
+            compare(r, opt, env);
+    }
+
+    // Welch's t-test of the mean load times, and a peak memory check.
+    void compare(const ParserResult& r, const TesterOptions& opt, const Environment& env)
+    {
+        const HistoryRecord* base = find_baseline(r, opt, env);
+        if (base == nullptr)
+        {
+            fprintf(report, "%-18s compare: no earlier result of build '%s'\n", r.parser, compare_to);
+            return;
+        }
+        const TimingStats& t = r.timing;
+        double time_change = t.mean / base->time_mean - 1;
+        bool slower = false;
+        char significance[64] = "needs --iterations 2+ on both builds";
+        if (t.count >= 2 && base->iterations >= 2)
+        {
+            double a = t.stddev * t.stddev / t.count;
+            double b = base->time_stddev * base->time_stddev / base->iterations;
+            double se = sqrt(a + b);
+            double tval = se > 0 ? (t.mean - base->time_mean) / se : (t.mean > base->time_mean ? INFINITY : 0);
+            double dof = se > 0 ? (a + b) * (a + b) / (a * a / (t.count - 1) + b * b / (base->iterations - 1)) : 1;
+            bool significant = tval > TimingStats::t_critical((int)dof);
+            slower = significant && time_change > kMinSlowdown;
+            snprintf(significance, sizeof(significance), "t=%.2f %s", tval, significant ? "significant" : "not significant");
+        }
+        double mem_change = base->peak_memory > 0 && r.stats.peak_memory > 0 ? (double)r.stats.peak_memory / base->peak_memory - 1 : 0;
+        bool more_memory = mem_change > kMinMemoryGrowth && r.stats.peak_memory - base->peak_memory > (1 << 20);
+        fprintf(report, "%-18s vs %s: time %+6.1f%% (%s) peak mem %+6.1f%%%s%s\n", r.parser, base->build_hash.c_str(),
+            time_change * 100, significance, mem_change * 100,
+            slower ? " SLOWER" : "", more_memory ? " MORE MEMORY" : "");
+        if (slower || more_memory)
+            ++regressions;
+    }
+};
+
+static void print_result(const ParserResult& r, const TesterOptions& opt)
+{
+    if (!r.error.empty())
+    {
+        printf("%-18s %s\n", r.parser, r.error.c_str());
+        return;
+    }
+    r.stats.print(r.parser);
+    if (opt.iterations > 1)
+        r.timing.print();
+    if (opt.phases)
+        r.stats.print_phases();
+    if (opt.counters)
+        r.stats.print_counters();
+    if (opt.allocs)
+        r.stats.print_allocs();
+    if (opt.cook && r.stats.ok)
+        r.stats.print_cooked();
+}
+
+static void write_result(FILE* out, const ParserResult& r, const TesterOptions& opt, int64_t file_size, const Environment& env)
+{
+    if (opt.format == OutputFormat::Json)
+        write_result_json(out, r, opt.filename, file_size, input_mode(opt), env);
+    else if (opt.format == OutputFormat::Csv)
+        write_result_csv(out, r, opt.filename, file_size, input_mode(opt), env);
+    else
+        print_result(r, opt);
+    fflush(out);
+}
+
+// Reruns the parser with the --noise background load running, and reports
+// how much slower that is than the quiet run.
+static void run_with_noise(FILE* out, const ObjParser& parser, const TesterOptions& opt, const ParserResult& quiet,
+    int64_t file_size, const Environment& env, History& history)
+{
+    opt.background->start();
+    ParserResult r = run_parser(parser, opt);
+    opt.background->stop();
+    r.noise = opt.noise;
+    history.add(r, opt, file_size, env);
+    if (opt.format != OutputFormat::Text)
+    {
+        write_result(out, r, opt, file_size, env);
+        return;
+    }
+    if (!r.error.empty() || !r.stats.ok)
+    {
+        printf("%-18s noise=%s %s\n", parser.name, opt.noise, r.error.empty() ? "failed" : r.error.c_str());
+        return;
+    }
+    double slowdown = quiet.stats.ok && quiet.stats.time > 0 ? r.stats.time / quiet.stats.time : -1;
+    printf("%-18s noise=%s t=%6.2f s quiet t=%6.2f s slowdown=%5.2fx%s\n", parser.name, opt.noise, r.stats.time,
+        quiet.stats.time, slowdown, r.timing.noisy ? " NOISY" : "");
+}
+
+// Reruns the multithreaded parsers at each of the requested thread counts,
+// and reports speedup and parallel efficiency relative to the first count.
+static void run_thread_sweep(FILE* out, const TesterOptions& opt, int64_t file_size, const Environment& env, History& history)
+{
+    for (const ObjParser* p : opt.parsers)
+    {
+        const ObjParser& parser = *p;
+        if (!parser.multithreaded)
+            continue;
+        double base_time = -1;
+        int base_threads = 0;
+        for (int threads : opt.thread_counts)
+        {
+            s_thread_count = threads;
+            if (!limit_cpu_count(threads))
+                fprintf(stderr, "Could not limit the process to %i CPUs\n", threads);
+            ParserResult r = run_parser(parser, opt);
+            r.threads = threads;
+            history.add(r, opt, file_size, env);
+            if (base_time < 0 && r.stats.ok)
+            {
+                base_time = r.stats.time;
+                base_threads = threads;
+            }
+            if (opt.format != OutputFormat::Text)
+            {
+                write_result(out, r, opt, file_size, env);
+                continue;
+            }
+            if (!r.error.empty() || !r.stats.ok)
+            {
+                printf("%-18s threads=%3i %s\n", parser.name, threads, r.error.empty() ? "failed" : r.error.c_str());
+                continue;
+            }
+            if (parser.fixed_worker_count)
+            {
+                // same workers on fewer cores, not fewer workers: no speedup/efficiency
+                printf("%-18s threads=%3i t=%6.2f s affinity-limited, worker count fixed at hardware_concurrency mem: %5i / %5i MB%s\n",
+                    parser.name, threads, r.stats.time,
+                    ObjParseStats::to_mb(r.stats.peak_memory), ObjParseStats::to_mb(r.stats.end_memory),
+                    r.timing.noisy ? " NOISY" : "");
+                continue;
+            }
+            double speedup = base_time / r.stats.time;
+            double efficiency = speedup * base_threads / threads;
+            printf("%-18s threads=%3i t=%6.2f s speedup=%5.2fx efficiency=%4.0f%% mem: %5i / %5i MB%s\n",
+                parser.name, threads, r.stats.time, speedup, efficiency * 100,
+                ObjParseStats::to_mb(r.stats.peak_memory), ObjParseStats::to_mb(r.stats.end_memory),
+                r.timing.noisy ? " NOISY" : "");
+        }
+    }
+    s_thread_count = 0;
+    limit_cpu_count(0);
+}
+
+// Names of the counts and hashes that differ between two loads, empty when
+// they loaded the same data in the same order.
+static std::string describe_differences(const ObjParseStats& a, const ObjParseStats& b)
+{
+    std::string res;
+    auto check = [&](bool same, const char* name)
+    {
+        if (!same)
+            res += res.empty() ? name : std::string(" ") + name;
+    };
+    check(a.vertex_count == b.vertex_count && a.normal_count == b.normal_count && a.uv_count == b.uv_count, "counts");
+    check(a.face_count == b.face_count && a.shape_count == b.shape_count && a.material_count == b.material_count, "faces/shapes");
+    check(a.vertex_hash == b.vertex_hash, "v");
+    check(a.normal_hash == b.normal_hash, "vn");
+    check(a.uv_hash == b.uv_hash, "vt");
+    check(a.topology_hash == b.topology_hash, "topo");
+    check(a.material_hash == b.material_hash, "mat");
+    check(a.group_hash == b.group_hash, "group");
+    check(a.order_hash == b.order_hash, "order");
+    return res;
+}
+
+// Loads with the multithreaded parsers --iterations times at each thread count
+// (the --threads list, or 1, 2, 4 and all cores), and checks that every run
+// returns the same data in the same order as the first one. Parsers with a
+// fixed worker count partition the file the same way at any CPU affinity, so
+// they get as many runs at their own count instead. Returns false if any run
+// differed.
+static bool run_determinism_check(FILE* out, const TesterOptions& opt, int64_t file_size, const Environment& env)
+{
+    std::vector<int> thread_counts = opt.thread_counts;
+    if (thread_counts.empty())
+    {
+        thread_counts = { 1, 2, 4 };
+        int cores = (int)std::thread::hardware_concurrency();
+        if (cores > 4)
+            thread_counts.push_back(cores);
+    }
+    const int hardware_threads = (int)std::thread::hardware_concurrency();
+    bool deterministic = true;
+    for (const ObjParser* p : opt.parsers)
+    {
+        const ObjParser& parser = *p;
+        if (!parser.multithreaded)
+            continue;
+        std::vector<int> parser_thread_counts = thread_counts;
+        int iterations = opt.iterations;
+        if (parser.fixed_worker_count)
+        {
+            parser_thread_counts = { hardware_threads };
+            iterations *= (int)thread_counts.size();
+            if (opt.format == OutputFormat::Text)
+                printf("%-18s worker count fixed at hardware_concurrency (%i), only checked at that partitioning\n", parser.name, hardware_threads);
+        }
+        ObjParseStats reference;
+        bool have_reference = false;
+        int runs = 0, differing = 0;
+        for (int threads : parser_thread_counts)
+        {
+            s_thread_count = threads;
+            if (!limit_cpu_count(threads))
+                fprintf(stderr, "Could not limit the process to %i CPUs\n", threads);
+            std::vector<double> times;
+            std::string differences, error;
+            for (int i = 0; i < opt.warmup + iterations && error.empty(); ++i)
+            {
+                ParserResult r;
+                r.parser = parser.name;
+                r.threads = threads;
+                if (!parse_once(parser, opt, r.stats, r.error) || !r.stats.ok)
+                {
+                    error = r.error.empty() ? "failed" : r.error;
+                    break;
+                }
+                if (i < opt.warmup)
+                    continue;
+                times.push_back(r.stats.time);
+                if (opt.format != OutputFormat::Text)
+                    write_result(out, r, opt, file_size, env);
+                ++runs;
+                if (!have_reference)
+                {
+                    reference = r.stats;
+                    have_reference = true;
+                    continue;
+                }
+                std::string diff = describe_differences(reference, r.stats);
+                if (!diff.empty())
+                {
+                    ++differing;
+                    if (differences.find(diff) == std::string::npos)
+                        differences += (differences.empty() ? "" : ", ") + diff;
+                }
+            }
+            if (opt.format != OutputFormat::Text)
+                continue;
+            if (times.empty())
+            {
+                printf("%-18s threads=%3i %s\n", parser.name, threads, error.c_str());
+                continue;
+            }
+            TimingStats timing;
+            timing.compute(times);
+            double max = *std::max_element(times.begin(), times.end());
+            printf("%-18s threads=%3i runs=%3i min=%.4f med=%.4f max=%.4f spread=%5.1f%% %s%s\n", parser.name, threads,
+                timing.count, timing.min, timing.median, max, (max - timing.min) / timing.median * 100,
+                differences.empty() ? "same" : "DIFFERS: ", differences.c_str());
+        }
+        if (opt.format == OutputFormat::Text && runs > 0)
+        {
+            if (differing > 0)
+                printf("%-18s NONDETERMINISTIC: %i of %i runs differ from the first one\n", parser.name, differing, runs);
+            else
+                printf("%-18s deterministic over %i runs\n", parser.name, runs);
+        }
+        deterministic &= differing == 0;
+    }
+    s_thread_count = 0;
+    limit_cpu_count(0);
+    return deterministic;
+}
+
+// Loads opt.concurrent files at once with each parser, one per thread, cycling
+// through the given files. Repeats that for the warmup and timed rounds, and
+// reports the aggregate throughput, load latencies and peak memory.
+static void run_concurrent(FILE* out, const TesterOptions& opt, const std::vector<std::string>& files,
+    const std::vector<int64_t>& file_sizes, const Environment& env, History& history)
+{
+    const int count = opt.concurrent;
+    int64_t total_bytes = 0;
+    for (int i = 0; i < count; ++i)
+        total_bytes += file_sizes[i % files.size()];
+
+    for (const ObjParser* parser : opt.parsers)
+    {
+        ParserResult result;
+        result.parser = parser->name;
+        result.concurrent = count;
+        ObjParseStats& res = result.stats;
+        std::vector<double> latencies, walls;
+        int failed = 0;
+        int64_t peak_memory = -1;
+        for (int round = 0; round < opt.warmup + opt.iterations; ++round)
+        {
+            std::vector<ObjParseStats> stats(count);
+            std::vector<double> starts(count);
+            std::atomic<int> ready{0};
+            std::atomic<bool> go{false};
+            std::chrono::steady_clock::time_point t0;
+            reset_peak_memory();
+            std::vector<std::thread> threads;
+            for (int i = 0; i < count; ++i)
+            {
+                threads.emplace_back([&, i]()
+                {
+                    ++ready;
+                    while (!go)
+                        std::this_thread::yield();
+                    starts[i] = get_duration(t0);
+                    stats[i] = parser->parse(files[i % files.size()].c_str());
+                });
+            }
+            // start all the loads at the same time
+            while (ready < count)
+                std::this_thread::yield();
+            t0 = get_time();
+            go = true;
+            for (std::thread& t : threads)
+                t.join();
+            if (round < opt.warmup)
+                continue;
+
+            // the round ends when the last load does, not counting the hashing done after it
+            double wall = 0;
+            res = ObjParseStats();
+            res.ok = true;
+            res.vertex_count = res.normal_count = res.uv_count = res.face_count = res.shape_count = res.material_count = 0;
+            for (int i = 0; i < count; ++i)
+            {
+                const ObjParseStats& st = stats[i];
+                if (!st.ok)
+                {
+                    ++failed;
+                    res.ok = false;
+                    continue;
+                }
+                wall = std::max(wall, starts[i] + st.time);
+                latencies.push_back(st.time);
+                res.vertex_count += st.vertex_count;
+                res.normal_count += st.normal_count;
+                res.uv_count += st.uv_count;
+                res.face_count += st.face_count;
+                res.shape_count += st.shape_count;
+                res.material_count += st.material_count;
+            }
+            walls.push_back(wall);
+            peak_memory = std::max(peak_memory, get_peak_memory());
+        }
+        if (!latencies.empty())
+            result.timing.compute(latencies);
+        std::sort(walls.begin(), walls.end());
+        res.time = walls.empty() ? -1 : TimingStats::percentile(walls, 0.5);
+        res.peak_memory = peak_memory;
+        res.end_memory = get_current_memory();
+        if (failed > 0)
+            result.error = std::to_string(failed) + " of " + std::to_string(count * opt.iterations) + " loads failed";
+        history.add(result, opt, total_bytes, env);
+        if (opt.format != OutputFormat::Text)
+        {
+            write_result(out, result, opt, total_bytes, env);
+            continue;
+        }
+        if (latencies.empty())
+        {
+            printf("%-18s %s\n", parser->name, result.error.c_str());
+            continue;
+        }
+        printf("%-18s loads=%3i failed=%i wall=%6.2f s %8.1f MB/s %7.2f loads/s latency: min=%.3f p50=%.3f p95=%.3f max=%.3f s mem: peak %5i MB%s\n",
+            parser->name, count, failed, res.time, total_bytes * 1.0e-6 / res.time, count / res.time,
+            result.timing.min, result.timing.median, result.timing.p95, *std::max_element(latencies.begin(), latencies.end()),
+            ObjParseStats::to_mb(peak_memory), result.timing.noisy ? " NOISY" : "");
+    }
+}
+
+// Totals of one parser over all the files of a batch run.
+struct ParserSummary
+{
+    const ObjParser* parser = nullptr;
+    int files = 0;
+    int failed = 0;
+    int64_t bytes = 0; // of the successfully loaded files
+    double time = 0;
+    double log_speedup_sum = 0; // over the files where both this and the baseline parser succeeded
+    int speedup_count = 0;
+
+    double geomean_speedup() const
+    {
+        return speedup_count > 0 ? exp(log_speedup_sum / speedup_count) : -1;
+    }
+};
+
+static void add_to_summary(std::vector<ParserSummary>& summary, const std::vector<ParserResult>& results, int64_t file_size, const ObjParser* baseline)
+{
+    double base_time = -1;
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        if (summary[i].parser == baseline && results[i].stats.ok)
+            base_time = results[i].stats.time;
+    }
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        ParserSummary& sum = summary[i];
+        const ObjParseStats& res = results[i].stats;
+        ++sum.files;
+        if (!res.ok || !results[i].error.empty())
+        {
+            ++sum.failed;
+            continue;
+        }
+        sum.bytes += file_size;
+        sum.time += res.time;
+        if (base_time > 0 && res.time > 0)
+        {
+            sum.log_speedup_sum += log(base_time / res.time);
+            ++sum.speedup_count;
+        }
+    }
+}
+
+static void print_summary(const std::vector<ParserSummary>& summary, const ObjParser* baseline, int file_count)
+{
+    printf("Summary of %i files, speedup relative to %s:\n", file_count, baseline->name);
+    printf("%-18s %5s %6s %10s %9s %9s %8s\n", "parser", "files", "failed", "total MB", "total s", "MB/s", "speedup");
+    for (const ParserSummary& sum : summary)
+    {
+        printf("%-18s %5i %6i %10.1f %9.3f %9.1f %7.2fx\n", sum.parser->name, sum.files, sum.failed,
+            sum.bytes * 1.0e-6, sum.time, sum.time > 0 ? sum.bytes * 1.0e-6 / sum.time : 0.0, sum.geomean_speedup());
+    }
+}
+
+// Throughput of every parser on one file of the --corpus
+struct CorpusResult
+{
+    std::string shape;
+    std::vector<double> mbs; // per parser, -1 when it failed
+};
+
+// Shapes that are at most this fraction of a parser's throughput on the
+// baseline shape are flagged, as likely superlinear or cliff behavior.
+static const double kCorpusSlowdownFlag = 0.5;
+
+static void add_to_corpus(std::vector<CorpusResult>& corpus, const std::string& shape, const std::vector<ParserResult>& results, int64_t file_size)
+{
+    CorpusResult row;
+    row.shape = shape;
+    for (const ParserResult& r : results)
+    {
+        bool ok = r.stats.ok && r.error.empty() && r.stats.time > 0;
+        row.mbs.push_back(ok ? file_size * 1.0e-6 / r.stats.time : -1);
+    }
+    corpus.push_back(row);
+}
+
+static void print_corpus(const std::vector<CorpusResult>& corpus, const std::vector<const ObjParser*>& parsers)
+{
+    const CorpusResult* base = nullptr;
+    for (const CorpusResult& row : corpus)
+    {
+        if (row.shape == kObjGenShapes[0])
+            base = &row;
+    }
+    printf("Corpus throughput, MB/s (relative to %s; ! at %.0f%% or less):\n", kObjGenShapes[0], kCorpusSlowdownFlag * 100);
+    printf("%-18s", "shape");
+    for (const ObjParser* parser : parsers)
+        printf(" %18s", parser->name);
+    printf("\n");
+    for (const CorpusResult& row : corpus)
+    {
+        printf("%-18s", row.shape.c_str());
+        for (size_t i = 0; i < row.mbs.size(); ++i)
+        {
+            if (row.mbs[i] < 0)
+            {
+                printf(" %18s", "failed");
+                continue;
+            }
+            double rel = base != nullptr && base->mbs[i] > 0 ? row.mbs[i] / base->mbs[i] : -1;
+            printf(" %9.1f ", row.mbs[i]);
+            if (rel > 0)
+                printf("%6.2fx%c", rel, rel <= kCorpusSlowdownFlag ? '!' : ' ');
+            else
+                printf("%8s", "");
+        }
+        printf("\n");
+    }
+}
+
+// Writes an obj_gen shape file of about size_mb into dir, unless it already
+// exists; the shape and size are in the file name. Returns the path, or an
+// empty string on failure.
+static std::string generate_input(const char* dir, const char* shape, double size_mb)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    char name[256];
+    snprintf(name, sizeof(name), "%s-%gmb.obj", shape, size_mb);
+    std::string path = (std::filesystem::path(dir) / name).string();
+    if (!std::filesystem::exists(path, ec))
+    {
+        ObjGenParams params;
+        obj_gen_apply_shape(params, shape, (uint64_t)(size_mb * kObjGenMB));
+        if (obj_gen_write_files(path.c_str(), params) == 0)
+        {
+            fprintf(stderr, "Can't write generated file '%s'\n", path.c_str());
+            return std::string();
+        }
+    }
+    return path;
+}
+
+// Adds the files of the pathological input corpus (all the obj_gen shapes).
+static bool generate_corpus(const char* dir, double size_mb, std::vector<std::string>& files, std::vector<std::string>& shapes)
+{
+    for (const char* shape : kObjGenShapes)
+    {
+        std::string path = generate_input(dir, shape, size_mb);
+        if (path.empty())
+            return false;
+        files.push_back(path);
+        shapes.push_back(shape);
+    }
+    return true;
+}
+
+// Load time and memory of every parser on one rung of the --size-ladder
+struct LadderResult
+{
+    int64_t file_size = 0;
+    std::vector<double> time; // per parser, -1 when it failed
+    std::vector<double> memory; // peak memory above the process baseline, bytes
+};
+
+// Parsers whose time or memory grows faster than bytes^this are flagged:
+// their cost per byte increases with the file size.
+static const double kSuperlinearExponent = 1.1;
+
+static void add_to_ladder(std::vector<LadderResult>& ladder, const std::vector<ParserResult>& results, int64_t file_size, int64_t base_memory)
+{
+    LadderResult rung;
+    rung.file_size = file_size;
+    for (const ParserResult& r : results)
+    {
+        bool ok = r.stats.ok && r.error.empty() && r.stats.time > 0;
+        rung.time.push_back(ok ? r.stats.time : -1);
+        rung.memory.push_back(ok && r.stats.peak_memory > base_memory ? double(r.stats.peak_memory - base_memory) : -1);
+    }
+    ladder.push_back(rung);
+}
+
+// Least squares fit of y = a * x^b in log-log space; returns b, or -1 with
+// fewer than two valid points (y <= 0 ones are skipped).
+static double fit_exponent(const std::vector<double>& x, const std::vector<double>& y, double& r2)
+{
+    double sx = 0, sy = 0, sxx = 0, sxy = 0, syy = 0;
+    int n = 0;
+    for (size_t i = 0; i < x.size(); ++i)
+    {
+        if (x[i] <= 0 || y[i] <= 0)
+            continue;
+        double lx = log(x[i]), ly = log(y[i]);
+        sx += lx;
+        sy += ly;
+        sxx += lx * lx;
+        sxy += lx * ly;
+        syy += ly * ly;
+        ++n;
+    }
+    r2 = -1;
+    double vx = n * sxx - sx * sx, vy = n * syy - sy * sy;
+    if (n < 2 || vx <= 0)
+        return -1;
+    double cov = n * sxy - sx * sy;
+    r2 = vy > 0 ? cov * cov / (vx * vy) : 1;
+    return cov / vx;
+}
+
+// The memory fit needs isolate: without it, the process peak includes what
+// earlier rungs, parsers and the allocator's free lists kept around.
+static void print_ladder(const std::vector<LadderResult>& ladder, const std::vector<const ObjParser*>& parsers, bool isolate)
+{
+    printf("Size ladder, load time in s and ns/byte:\n");
+    printf("%-18s", "parser");
+    for (const LadderResult& rung : ladder)
+        printf(" %9.1fMB", rung.file_size * 1.0e-6);
+    printf("   time~bytes^b (r2)   mem~bytes^b (r2)\n");
+    for (size_t p = 0; p < parsers.size(); ++p)
+    {
+        printf("%-18s", parsers[p]->name);
+        std::vector<double> bytes, times, memory;
+        for (const LadderResult& rung : ladder)
+        {
+            if (rung.time[p] > 0)
+                printf(" %6.2f/%4.1f", rung.time[p], rung.time[p] * 1.0e9 / rung.file_size);
+            else
+                printf(" %11s", "failed");
+            bytes.push_back((double)rung.file_size);
+            times.push_back(rung.time[p]);
+            memory.push_back(rung.memory[p]);
+        }
+        double time_r2, memory_r2;
+        double time_exp = fit_exponent(bytes, times, time_r2);
+        double memory_exp = isolate ? fit_exponent(bytes, memory, memory_r2) : -1;
+        char time_fit[32] = "n/a", memory_fit[32] = "n/a";
+        if (!isolate)
+            snprintf(memory_fit, sizeof(memory_fit), "n/a (needs --isolate)");
+        if (time_exp >= 0)
+            snprintf(time_fit, sizeof(time_fit), "%5.2f (%4.2f)", time_exp, time_r2);
+        if (memory_exp >= 0)
+            snprintf(memory_fit, sizeof(memory_fit), "%5.2f (%4.2f)", memory_exp, memory_r2);
+        printf("   %-17s   %s", time_fit, memory_fit);
+        if (time_exp > kSuperlinearExponent || memory_exp > kSuperlinearExponent)
+            printf("  SUPERLINEAR %s", time_exp > kSuperlinearExponent ? (memory_exp > kSuperlinearExponent ? "time+memory" : "time") : "memory");
+        printf("\n");
+    }
+}
+
+static bool parse_int_list(const char* str, std::vector<int>& list)
+{
+    list.clear();
+    while (*str)
+    {
+        char* end = nullptr;
+        long val = strtol(str, &end, 10);
+        if (end == str || val <= 0)
+            return false;
+        list.push_back((int)val);
+        str = end;
+        if (*str == ',')
+            ++str;
+        else if (*str != 0)
+            return false;
+    }
+    return !list.empty();
+}
+
+static bool parse_parser_list(const char* str, std::vector<const ObjParser*>& list)
+{
+    list.clear();
+    for (const ObjParser& parser : kParsers)
+    {
+        // keep the kParsers order, whatever order the names were given in
+        size_t len = strlen(parser.name);
+        for (const char* name = str; *name; )
+        {
+            const char* end = strchr(name, ',');
+            size_t name_len = end ? end - name : strlen(name);
+            if (name_len == len && strncmp(name, parser.name, len) == 0)
+            {
+                list.push_back(&parser);
+                break;
+            }
+            name += name_len + (end ? 1 : 0);
+        }
+    }
+    // every given name has to be a known parser
+    size_t names = 1;
+    for (const char* c = str; *c; ++c)
+        names += *c == ',';
+    return !list.empty() && list.size() == names;
+}
+
+static const ObjParser* find_parser(const char* name)
+{
+    for (const ObjParser& parser : kParsers)
+    {
+        if (strcmp(parser.name, name) == 0)
+            return &parser;
+    }
+    return nullptr;
+}
+
+// `*` and `?` wildcard match.
+static bool match_wildcard(const char* pattern, const char* str)
+{
+    if (*pattern == 0)
+        return *str == 0;
+    if (*pattern == '*')
+        return match_wildcard(pattern + 1, str) || (*str != 0 && match_wildcard(pattern, str + 1));
+    if (*str != 0 && (*pattern == '?' || *pattern == *str))
+        return match_wildcard(pattern + 1, str + 1);
+    return false;
+}
+
+// Expands an input argument into the files to test: a directory gives all
+// the .obj files under it, a wildcard pattern (in the file name part only)
+// gives the matching files, anything else is used as is.
+static void expand_input(const std::string& input, std::vector<std::string>& files)
+{
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    std::vector<std::string> found;
+    if (fs::is_directory(input, ec))
+    {
+        for (fs::recursive_directory_iterator it(input, ec), end; !ec && it != end; it.increment(ec))
+        {
+            std::string ext = it->path().extension().string();
+            std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+            if (it->is_regular_file(ec) && ext == ".obj")
+                found.push_back(it->path().string());
+        }
+    }
+    else if (input.find_first_of("*?") != std::string::npos)
+    {
+        fs::path pattern(input);
+        fs::path dir = pattern.has_parent_path() ? pattern.parent_path() : fs::path(".");
+        std::string name_pattern = pattern.filename().string();
+        for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec))
+        {
+            if (it->is_regular_file(ec) && match_wildcard(name_pattern.c_str(), it->path().filename().string().c_str()))
+                found.push_back(pattern.has_parent_path() ? it->path().string() : it->path().filename().string());
+        }
+    }
+    else
+    {
+        files.push_back(input);
+        return;
+    }
+    if (found.empty())
+        fprintf(stderr, "No .obj files found in '%s'\n", input.c_str());
+    std::sort(found.begin(), found.end());
+    files.insert(files.end(), found.begin(), found.end());
+}
+
+static bool readthefile(const char* filename, int64_t* outSize)
+{
+    // just read the file in, to prewarm OS file caches
+    size_t size = 0;
+    const char* filebuf = read_file(filename, &size);
+    if (filebuf == nullptr)
+    {
+        fprintf(stderr, "Can't read the file!\n");
+        return false;
+    }
+    delete[] filebuf;
+    *outSize = (int64_t)size;
+    return true;
+}
+
+static void print_usage()
+{
+    printf("USAGE: obj_parse_tester [options] <obj files, directories or wildcards...>\n");
+    printf("  --parsers LIST  only run the given parsers, e.g. rapidobj,blender\n");
+    printf("  --baseline P    parser the speedups of the multi-file summary are relative to (default: first one)\n");
+    printf("  --iterations N  time each parser N times and report statistics (default 1)\n");
+    printf("  --warmup M      untimed runs of each parser before the timed ones (default 0)\n");
+    printf("  --isolate       run every load in a separate forked process (not on Windows)\n");
+    printf("  --shuffle       run the parsers in a new random order in every iteration, instead of one after another\n");
+    printf("  --shuffle-seed N  random seed of --shuffle (default 1)\n");
+    printf("  --pin CPU       pin the single threaded parsers to the given CPU during loads (Linux only)\n");
+    printf("  --spin-ms N     busy loop N ms before each load, to get the CPU to a steady frequency\n");
+    printf("  --format F      output format: text (default), json (one object per line) or csv\n");
+    printf("  --output FILE   append json/csv results to FILE instead of printing them\n");
+    printf("  --threads LIST  thread scaling sweep of the multithreaded parsers, e.g. 1,2,4,8\n");
+    printf("  --determinism   check that the multithreaded parsers load the same data in the same order in every run, at\n");
+    printf("                  every --threads count (default 1,2,4,all cores); exit code 3 if not\n");
+    printf("  --phases        also print read/parse/finalize time split, where observable\n");
+    printf("  --cold          evict the file from the OS page cache before every load (Linux only)\n");
+    printf("  --concurrent K  load K files (cycling through the given ones) at once in separate threads with each parser\n");
+    printf("  --memory        load the file into memory once, and have all parsers parse it from there\n");
+    printf("  --corpus DIR    also test the pathological input shapes of obj_gen (generated into DIR), and print a\n");
+    printf("                  per-shape throughput table\n");
+    printf("  --corpus-mb N   size of the corpus files (default 10)\n");
+    printf("  --size-ladder DIR  also test files of growing size (generated into DIR), and fit time and memory against size\n");
+    printf("  --ladder-mb LIST   sizes of the ladder files (default 1,4,16,64)\n");
+    printf("  --ladder-shape S   obj_gen shape of the ladder files (default baseline)\n");
+    printf("  --speed-of-light  time read_file, memcpy, newline count and tokenizer kernels on every file, and show the\n");
+    printf("                  parsers' throughput as a fraction of those\n");
+    printf("  --io-strategies compare the read throughput of fread, read, O_DIRECT, fadvise and mmap on every file\n");
+    printf("  --read-strategy S  how to read the --memory buffer: %s (default: best with --io-strategies, else fread)\n",
+        "fread, read, direct, fadvise, mmap or mmap-populate");
+    printf("  --history FILE  append the results to a json lines history file\n");
+    printf("  --compare-to B  compare with the results of build B (or 'previous') in the history, exit code 2 on regressions\n");
+    printf("  --build-id ID   build hash recorded in the results (default: source revision (git describe --dirty) at build time)\n");
+    printf("  --noise LIST    also run each parser with a background load: cpu[:N] spinning threads, membw[:N] memory\n");
+    printf("                  streaming threads, pagecache[:N] large file readers; e.g. cpu:8,membw:2\n");
+    printf("  --noise-file-mb N  size of the pagecache reader file (default 1024)\n");
+    printf("  --noise-dir DIR    directory of the pagecache reader file, not on tmpfs (default: the first input file's)\n");
+    printf("  --noise-keep-file  do not delete the pagecache reader file at exit, so that later runs reuse it\n");
+    printf("  --cook          also convert the loaded data into render-ready vertex/index buffers, and time that\n");
+    printf("  --allocs        track heap allocations (needs a build with OBJ_ALLOC_PROFILE)\n");
+    printf("  --counters      count cycles, instructions, cache/branch misses etc. with perf_event_open (Linux only)\n");
+}
+
+static bool parse_options(int argc, const char* argv[], TesterOptions& opt)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--iterations") == 0 && i + 1 < argc)
+            opt.iterations = atoi(argv[++i]);
+        else if (strcmp(arg, "--warmup") == 0 && i + 1 < argc)
+            opt.warmup = atoi(argv[++i]);
+        else if (strcmp(arg, "--isolate") == 0)
+            opt.isolate = true;
+        else if (strcmp(arg, "--phases") == 0)
+            opt.phases = true;
+        else if (strcmp(arg, "--cold") == 0)
+            opt.cold = true;
+        else if (strcmp(arg, "--memory") == 0)
+            opt.memory = true;
+        else if (strcmp(arg, "--corpus") == 0 && i + 1 < argc)
+            opt.corpus = argv[++i];
+        else if (strcmp(arg, "--corpus-mb") == 0 && i + 1 < argc)
+        {
+            if ((opt.corpus_mb = atof(argv[++i])) <= 0)
+                return false;
+        }
+        else if (strcmp(arg, "--size-ladder") == 0 && i + 1 < argc)
+            opt.ladder = argv[++i];
+        else if (strcmp(arg, "--ladder-mb") == 0 && i + 1 < argc)
+        {
+            if (!parse_int_list(argv[++i], opt.ladder_mb))
+                return false;
+        }
+        else if (strcmp(arg, "--ladder-shape") == 0 && i + 1 < argc)
+        {
+            opt.ladder_shape = argv[++i];
+            ObjGenParams params;
+            if (!obj_gen_apply_shape(params, opt.ladder_shape, 1024))
+                return false;
+        }
+        else if (strcmp(arg, "--io-strategies") == 0)
+            opt.io_strategies = true;
+        else if (strcmp(arg, "--speed-of-light") == 0)
+            opt.speed_of_light = true;
+        else if (strcmp(arg, "--determinism") == 0)
+            opt.determinism = true;
+        else if (strcmp(arg, "--shuffle") == 0)
+            opt.shuffle = true;
+        else if (strcmp(arg, "--shuffle-seed") == 0 && i + 1 < argc)
+            opt.shuffle_seed = (unsigned)strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(arg, "--pin") == 0 && i + 1 < argc)
+        {
+            if ((opt.pin_cpu = atoi(argv[++i])) < 0)
+                return false;
+        }
+        else if (strcmp(arg, "--spin-ms") == 0 && i + 1 < argc)
+        {
+            if ((opt.spin_ms = atoi(argv[++i])) < 0)
+                return false;
+        }
+        else if (strcmp(arg, "--noise") == 0 && i + 1 < argc)
+            opt.noise = argv[++i];
+        else if (strcmp(arg, "--noise-file-mb") == 0 && i + 1 < argc)
+        {
+            if ((opt.noise_file_mb = atoll(argv[++i])) < 1)
+                return false;
+        }
+        else if (strcmp(arg, "--noise-dir") == 0 && i + 1 < argc)
+            opt.noise_dir = argv[++i];
+        else if (strcmp(arg, "--noise-keep-file") == 0)
+            opt.noise_keep_file = true;
+        else if (strcmp(arg, "--read-strategy") == 0 && i + 1 < argc)
+        {
+            const char* name = argv[++i];
+            for (int k = 0; k < (int)ReadStrategy::Count; ++k)
+            {
+                if (strcmp(name, kReadStrategyNames[k]) == 0)
+                    opt.read_strategy = k;
+            }
+            if (opt.read_strategy < 0)
+                return false;
+        }
+        else if (strcmp(arg, "--concurrent") == 0 && i + 1 < argc)
+        {
+            if ((opt.concurrent = atoi(argv[++i])) < 1)
+                return false;
+        }
+        else if (strcmp(arg, "--counters") == 0)
+            opt.counters = true;
+        else if (strcmp(arg, "--allocs") == 0)
+            opt.allocs = true;
+        else if (strcmp(arg, "--cook") == 0)
+            opt.cook = true;
+        else if (strcmp(arg, "--history") == 0 && i + 1 < argc)
+            opt.history = argv[++i];
+        else if (strcmp(arg, "--compare-to") == 0 && i + 1 < argc)
+            opt.compare_to = argv[++i];
+        else if (strcmp(arg, "--build-id") == 0 && i + 1 < argc)
+            opt.build_id = argv[++i];
+        else if (strcmp(arg, "--format") == 0 && i + 1 < argc)
+        {
+            const char* fmt = argv[++i];
+            if (strcmp(fmt, "text") == 0)
+                opt.format = OutputFormat::Text;
+            else if (strcmp(fmt, "json") == 0)
+                opt.format = OutputFormat::Json;
+            else if (strcmp(fmt, "csv") == 0)
+                opt.format = OutputFormat::Csv;
+            else
+                return false;
+        }
+        else if (strcmp(arg, "--output") == 0 && i + 1 < argc)
+            opt.output = argv[++i];
+        else if (strcmp(arg, "--threads") == 0 && i + 1 < argc)
+        {
+            if (!parse_int_list(argv[++i], opt.thread_counts))
+                return false;
+        }
+        else if (strcmp(arg, "--parsers") == 0 && i + 1 < argc)
+        {
+            if (!parse_parser_list(argv[++i], opt.parsers))
+                return false;
+        }
+        else if (strcmp(arg, "--baseline") == 0 && i + 1 < argc)
+        {
+            if ((opt.baseline = find_parser(argv[++i])) == nullptr)
+                return false;
+        }
+        else if (arg[0] == '-' && arg[1] == '-')
+            return false;
+        else
+            opt.inputs.push_back(arg);
+    }
+    if (opt.parsers.empty())
+    {
+        for (const ObjParser& parser : kParsers)
+            opt.parsers.push_back(&parser);
+    }
+    if (opt.baseline == nullptr)
+        opt.baseline = opt.parsers[0];
+    else if (std::find(opt.parsers.begin(), opt.parsers.end(), opt.baseline) == opt.parsers.end())
+        return false;
+    if ((opt.compare_to != nullptr && opt.history == nullptr) || (opt.cold && opt.memory))
+        return false;
+    // concurrent loads share the process, and the per-load measurements that
+    // are process wide can not be attributed to one load
+    if (opt.concurrent > 0 && (opt.isolate || opt.memory || opt.cold || opt.counters || opt.allocs || !opt.thread_counts.empty()))
+        return false;
+    if (opt.concurrent > 0 && (opt.io_strategies || opt.determinism || opt.noise != nullptr))
+        return false;
+    if (opt.concurrent > 0 && (opt.pin_cpu >= 0 || opt.spin_ms > 0 || opt.shuffle))
+        return false;
+    if (opt.noise != nullptr && !BackgroundLoad().parse(opt.noise))
+        return false;
+    // the perf counters are inherited by every thread started while they
+    // are open, so they would count the background load too
+    if (opt.noise != nullptr && opt.counters)
+        return false;
+    return (!opt.inputs.empty() || opt.corpus != nullptr || opt.ladder != nullptr) && opt.iterations >= 1 && opt.warmup >= 0;
+}
+
+int main(int argc, const char* argv[])
+{
+    TesterOptions opt;
+    if (!parse_options(argc, argv, opt))
+    {
+        print_usage();
+        return -1;
+    }
+    s_perf_counters_enabled = opt.counters;
+    probe_perf_counters();
+    s_alloc_tracking_enabled = opt.allocs;
+    s_cook_enabled = opt.cook;
+    #ifndef OBJ_ALLOC_PROFILE
+    if (opt.allocs)
+    {
+        fprintf(stderr, "--allocs needs obj_parse_tester built with the OBJ_ALLOC_PROFILE CMake option\n");
+        return 1;
+    }
+    #endif
+    std::vector<std::string> files;
+    for (const std::string& input : opt.inputs)
+        expand_input(input, files);
+    // corpus shape of each file, empty for the user given ones
+    std::vector<std::string> file_shapes(files.size());
+    if (opt.corpus != nullptr && !generate_corpus(opt.corpus, opt.corpus_mb, files, file_shapes))
+        return 1;
+    // whether each file is a --size-ladder rung
+    std::vector<char> file_in_ladder(files.size());
+    for (size_t i = 0; opt.ladder != nullptr && i < opt.ladder_mb.size(); ++i)
+    {
+        std::string path = generate_input(opt.ladder, opt.ladder_shape, opt.ladder_mb[i]);
+        if (path.empty())
+            return 1;
+        files.push_back(path);
+        file_shapes.push_back(std::string());
+        file_in_ladder.push_back(1);
+    }
+    file_in_ladder.resize(files.size());
+    if (files.empty())
+        return 1;
+
+    BackgroundLoad background;
+    if (opt.noise != nullptr)
+    {
+        background.parse(opt.noise);
+        background.file_mb = opt.noise_file_mb;
+        background.keep_file = opt.noise_keep_file;
+        std::string dir = opt.noise_dir != nullptr ? opt.noise_dir : std::filesystem::path(files[0]).parent_path().string();
+        if (dir.empty())
+            dir = ".";
+        if (background.needs_file() && BackgroundLoad::is_memory_fs(dir))
+        {
+            fprintf(stderr, "--noise pagecache needs a directory on a storage device, '%s' is in memory (tmpfs); use --noise-dir\n", dir.c_str());
+            return 1;
+        }
+        if (!background.prepare(dir))
+        {
+            fprintf(stderr, "Can't write the --noise page cache reader file into '%s'\n", dir.c_str());
+            return 1;
+        }
+        opt.background = &background;
+    }
+
+    FILE* out = stdout;
+    if (opt.format != OutputFormat::Text && opt.output != nullptr)
+    {
+        out = fopen(opt.output, "a");
+        if (!out)
+        {
+            fprintf(stderr, "Can't open output file '%s'\n", opt.output);
+            return 1;
+        }
+    }
+    Environment env = capture_environment();
+    if (opt.build_id != nullptr)
+        env.build_hash = opt.build_id;
+    History history;
+    if (opt.history != nullptr && !history.open(opt.history, opt.compare_to))
+    {
+        fprintf(stderr, "Can't open history file '%s'\n", opt.history);
+        return 1;
+    }
+    // comparisons are printed as text, so do not mix them into json/csv output
+    if (opt.format != OutputFormat::Text && out == stdout)
+        history.report = stderr;
+    if (opt.format == OutputFormat::Csv)
+    {
+        fseek(out, 0, SEEK_END);
+        if (ftell(out) <= 0)
+            write_csv_header(out);
+    }
+
+    if (opt.concurrent > 0)
+    {
+        std::vector<int64_t> file_sizes(files.size());
+        for (size_t i = 0; i < files.size(); ++i)
+        {
+            if (!readthefile(files[i].c_str(), &file_sizes[i]))
+                return 1;
+        }
+        // results are labelled with the file, or with the inputs when there are several
+        std::string label = files.size() == 1 ? files[0] : "";
+        for (size_t i = 0; files.size() > 1 && i < opt.inputs.size(); ++i)
+            label += (i ? " " : "") + opt.inputs[i];
+        TesterOptions run_opt = opt;
+        run_opt.filename = label.c_str();
+        if (opt.format == OutputFormat::Text)
+            printf("Files: %s (%i concurrent loads)\n", label.c_str(), opt.concurrent);
+        run_concurrent(out, run_opt, files, file_sizes, env, history);
+        files.clear();
+    }
+
+    std::vector<ParserSummary> summary(opt.parsers.size());
+    for (size_t i = 0; i < opt.parsers.size(); ++i)
+        summary[i].parser = opt.parsers[i];
+    std::vector<CorpusResult> corpus;
+    std::vector<LadderResult> ladder;
+    std::mt19937 rng(opt.shuffle_seed);
+    const int64_t base_memory = get_current_memory();
+    bool all_read = true;
+    bool nondeterministic = false;
+    for (size_t file_index = 0; file_index < files.size(); ++file_index)
+    {
+        const std::string& file = files[file_index];
+        TesterOptions file_opt = opt;
+        file_opt.filename = file.c_str();
+        if (opt.format == OutputFormat::Text)
+            printf("File: %s (%s)\n", file_opt.filename, opt.memory ? "from memory" : opt.cold ? "cold cache" : "warm cache");
+        int64_t file_size = 0;
+        if (!readthefile(file_opt.filename, &file_size))
+        {
+            all_read = false;
+            continue;
+        }
+        ReadStrategy read_strategy = opt.read_strategy >= 0 ? (ReadStrategy)opt.read_strategy : ReadStrategy::Fread;
+        if (opt.io_strategies)
+        {
+            ReadStrategyResults io;
+            io.run(file_opt.filename, file_size, opt.iterations);
+            if (opt.format == OutputFormat::Text || out != stdout)
+                io.print();
+            if (opt.read_strategy < 0 && ReadStrategyResults::best(io.warm_mbs) != ReadStrategy::Count)
+                read_strategy = ReadStrategyResults::best(io.warm_mbs);
+            else if (opt.read_strategy < 0 && opt.memory && opt.format == OutputFormat::Text)
+                printf("%-18s no read strategy worked, falling back to fread\n", "memory buffer:");
+        }
+        SpeedOfLight speed_of_light;
+        if (opt.speed_of_light)
+        {
+            speed_of_light.run(file_opt.filename, opt.iterations);
+            if (opt.format == OutputFormat::Text || out != stdout)
+                speed_of_light.print();
+        }
+        FileData memory_input;
+        // s_memory_input points into memory_input, so clear it whenever this
+        // iteration ends, before memory_input gets freed
+        struct MemoryInputReset
+        {
+            ~MemoryInputReset() { s_memory_input = InputBuffer(); }
+        } memory_input_reset;
+        if (opt.memory)
+        {
+            if (!read_file_with(read_strategy, file_opt.filename, memory_input))
+            {
+                fprintf(stderr, "Can't read the file with %s!\n", kReadStrategyNames[(int)read_strategy]);
+                all_read = false;
+                continue;
+            }
+            if (opt.format == OutputFormat::Text)
+                printf("%-18s %s\n", "memory buffer read:", kReadStrategyNames[(int)read_strategy]);
+            s_memory_input.filename = file_opt.filename;
+            s_memory_input.data = memory_input.data;
+            s_memory_input.size = memory_input.size;
+        }
+
+        if (opt.determinism)
+        {
+            nondeterministic |= !run_determinism_check(out, file_opt, file_size, env);
+            continue;
+        }
+        if (!opt.thread_counts.empty())
+        {
+            run_thread_sweep(out, file_opt, file_size, env, history);
+            continue;
+        }
+        std::vector<ParserResult> results;
+        if (opt.shuffle)
+            results = run_parsers_shuffled(file_opt, rng);
+        for (size_t i = 0; i < opt.parsers.size(); ++i)
+        {
+            const ObjParser& parser = *opt.parsers[i];
+            if (!opt.shuffle)
+                results.push_back(run_parser(parser, file_opt));
+            write_result(out, results[i], file_opt, file_size, env);
+            history.add(results[i], file_opt, file_size, env);
+            if (opt.background != nullptr)
+                run_with_noise(out, parser, file_opt, results[i], file_size, env, history);
+        }
+        add_to_summary(summary, results, file_size, opt.baseline);
+        for (size_t i = 0; opt.speed_of_light && i < results.size() && (opt.format == OutputFormat::Text || out != stdout); ++i)
+        {
+            if (results[i].stats.ok && results[i].error.empty() && results[i].stats.time > 0)
+                speed_of_light.print_fractions(results[i].parser, file_size * 1.0e-6 / results[i].stats.time);
+        }
+        if (!file_shapes[file_index].empty())
+            add_to_corpus(corpus, file_shapes[file_index], results, file_size);
+        if (file_in_ladder[file_index])
+            add_to_ladder(ladder, results, file_size, base_memory);
+    }
+    // the summary is printed as text, so only when it does not get mixed into json/csv output
+    if (opt.thread_counts.empty() && !opt.determinism && files.size() > 1 && (opt.format == OutputFormat::Text || out != stdout))
+        print_summary(summary, opt.baseline, (int)files.size());
+    if (!corpus.empty() && (opt.format == OutputFormat::Text || out != stdout))
+        print_corpus(corpus, opt.parsers);
+    if (!ladder.empty() && (opt.format == OutputFormat::Text || out != stdout))
+        print_ladder(ladder, opt.parsers, opt.isolate);
+    if (out != stdout)
+        fclose(out);
+    history.close();
+    if (!all_read)
+        return 1;
+    if (history.regressions > 0)
+    {
+        fprintf(history.report, "%i regressions compared to build '%s'\n", history.regressions, opt.compare_to);
+        return 2;
     }
-    const char* filename = argv[1];
-    printf("File: %s\n", filename);
-    if (!readthefile(filename)) return 1;
-
-    parse_tinyobjloader(filename);
-    parse_tinyobjloader_opt(filename);
-    parse_fast_obj(filename);
-    parse_rapidobj(filename);
-    parse_openscenegraph(filename);
-    parse_blender(filename);
-    parse_assimp(filename);
+    if (nondeterministic)
+        return 3;
     return 0;
 }